@@ -0,0 +1,149 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 13:14:52 PDT 2026
+// Last Modified: Sat Oct 17 14:02:37 PDT 2026 Added vectorized event filtering.
+// Filename:      midifile/include/MidiColumns.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   A read-only snapshot of the events in a MidiFile stored
+//                as parallel arrays (one array per event field) for fast
+//                analysis loops.  Events are stored by track, in the
+//                order of each track in the MidiFile.  Channel messages
+//                are stored in the status, data1 and data2 arrays.
+//                Meta messages, system exclusives and ill-formed
+//                messages are stored complete in a payload array.
+//                The find functions search the columns with SSE2
+//                instructions when available (16 events at a time),
+//                otherwise with scalar code.
+//
+
+#ifndef _MIDICOLUMNS_H_INCLUDED
+#define _MIDICOLUMNS_H_INCLUDED
+
+#include "MidiFile.h"
+
+#include <cstdint>
+#include <vector>
+
+
+namespace smf {
+
+class MidiColumns {
+	public:
+		                MidiColumns            (void);
+		                MidiColumns            (const MidiFile& midifile);
+
+		               ~MidiColumns            ();
+
+		void            build                  (const MidiFile& midifile);
+		void            clear                  (void);
+
+		int             getEventCount          (void) const;
+		int             size                   (void) const { return getEventCount(); }
+		int             getTrackCount          (void) const;
+		int             getTrackStart          (int track) const;
+		int             getTrackEnd            (int track) const;
+		int             getTicksPerQuarterNote (void) const;
+
+		// column access:
+		const std::vector<int>&    getTicks    (void) const { return m_tick; }
+		const std::vector<double>& getSeconds  (void) const { return m_seconds; }
+		const std::vector<int>&    getTracks   (void) const { return m_track; }
+		const std::vector<uchar>&  getStatus   (void) const { return m_status; }
+		const std::vector<uchar>&  getData1    (void) const { return m_data1; }
+		const std::vector<uchar>&  getData2    (void) const { return m_data2; }
+
+		// payload access for meta, sysex and ill-formed messages:
+		const uchar*    getPayload             (int index) const;
+		int             getPayloadSize         (int index) const;
+		void            getMessage             (int index,
+		                                        std::vector<uchar>& message) const;
+
+		// event filtering (track -1 means all tracks; returns match count):
+		int             findEvents             (std::vector<int>& indexes,
+		                                        int statusMask, int statusValue,
+		                                        int minData1 = 0, int maxData1 = 255,
+		                                        int minData2 = 0, int maxData2 = 255,
+		                                        int track = -1) const;
+		int             markEvents             (std::vector<uint64_t>& mask,
+		                                        int statusMask, int statusValue,
+		                                        int minData1 = 0, int maxData1 = 255,
+		                                        int minData2 = 0, int maxData2 = 255,
+		                                        int track = -1) const;
+		int             findNoteOns            (std::vector<int>& indexes,
+		                                        int channel = -1, int minKey = 0,
+		                                        int maxKey = 127, int track = -1) const;
+		int             findNoteOffs           (std::vector<int>& indexes,
+		                                        int channel = -1, int minKey = 0,
+		                                        int maxKey = 127, int track = -1) const;
+		int             findControllers        (std::vector<int>& indexes,
+		                                        int channel = -1, int number = -1,
+		                                        int track = -1) const;
+		int             findSustainOns         (std::vector<int>& indexes,
+		                                        int channel = -1, int track = -1) const;
+		int             findSustainOffs        (std::vector<int>& indexes,
+		                                        int channel = -1, int track = -1) const;
+
+		static int      getMaskIndexes         (std::vector<int>& indexes,
+		                                        const std::vector<uint64_t>& mask);
+
+	protected:
+		// m_tick == Absolute tick time of each event.
+		std::vector<int> m_tick;
+
+		// m_seconds == Time in seconds of each event (0.0 if the
+		// time analysis was not done on the MidiFile).
+		std::vector<double> m_seconds;
+
+		// m_track == Track index of the event in the MidiFile.
+		std::vector<int> m_track;
+
+		// m_status == Command byte of the message.  0x00 for messages
+		// which are stored in the payload except meta and system
+		// exclusive messages, which store their first byte.
+		std::vector<uchar> m_status;
+
+		// m_data1 == First data byte for channel messages, or the meta
+		// message type for meta messages.  Otherwise 0.
+		std::vector<uchar> m_data1;
+
+		// m_data2 == Second data byte for channel messages with two
+		// data bytes.  Otherwise 0.
+		std::vector<uchar> m_data2;
+
+		// m_payloadOffset == Start of each event in m_payload, with an
+		// extra entry at the end.  Channel messages have no payload.
+		std::vector<int> m_payloadOffset;
+
+		// m_payload == Bytes of all messages which are not well-formed
+		// channel messages.
+		std::vector<uchar> m_payload;
+
+		// m_trackStart == Index of the first event of each track, with an
+		// extra entry at the end for the total event count.
+		std::vector<int> m_trackStart;
+
+		// m_ticksPerQuarterNote == The TPQ of the source MidiFile.
+		int m_ticksPerQuarterNote = 120;
+
+	private:
+		void            prepareMask            (std::vector<uint64_t>& mask,
+		                                        int track, int& startindex,
+		                                        int& endindex) const;
+		void            matchEvents            (std::vector<uint64_t>& mask,
+		                                        int startindex, int endindex,
+		                                        int statusMask, int statusValue,
+		                                        int minData1, int maxData1,
+		                                        int minData2, int maxData2) const;
+		static int      countBits              (const std::vector<uint64_t>& mask);
+
+};
+
+} // end of namespace smf
+
+#endif /* _MIDICOLUMNS_H_INCLUDED */
+
+
+
@@ -0,0 +1,61 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 12:31:07 PDT 2026
+// Last Modified: Sat Oct 17 12:31:07 PDT 2026
+// Filename:      midifile/include/MidiCompactEvent.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   A MidiCompactMessage with the timestamp and track
+//                information of a MidiEvent.  Intended to be stored
+//                by value in a std::vector for compact in-memory scans
+//                of MIDI events.  Event linking is not supported.
+//
+
+#ifndef _MIDICOMPACTEVENT_H_INCLUDED
+#define _MIDICOMPACTEVENT_H_INCLUDED
+
+#include "MidiCompactMessage.h"
+#include "MidiEvent.h"
+#include "MidiEventList.h"
+
+#include <vector>
+
+
+namespace smf {
+
+class MidiCompactEvent : public MidiCompactMessage {
+	public:
+		                  MidiCompactEvent     (void);
+		                  MidiCompactEvent     (int aTime, int aTrack,
+		                                        const std::vector<uchar>& message);
+		                  MidiCompactEvent     (const MidiEvent& event);
+		                  MidiCompactEvent     (const MidiCompactEvent& event) = default;
+		                  MidiCompactEvent     (MidiCompactEvent&& event) = default;
+
+		MidiCompactEvent& operator=            (const MidiCompactEvent& event) = default;
+		MidiCompactEvent& operator=            (MidiCompactEvent&& event) = default;
+		MidiCompactEvent& operator=            (const MidiEvent& event);
+
+		void              getMidiEvent         (MidiEvent& event) const;
+		MidiEvent         getMidiEvent         (void) const;
+
+		static void       fromEventList        (std::vector<MidiCompactEvent>& output,
+		                                        const MidiEventList& events);
+		static void       toEventList          (MidiEventList& output,
+		                                        const std::vector<MidiCompactEvent>& events);
+
+		int        tick    = 0;    // delta or absolute MIDI ticks
+		int        track   = 0;    // [original] track number of event in MIDI file
+		double     seconds = 0.0;  // calculated time in sec. (after doTimeAnalysis())
+		int        seq     = 0;    // sorting sequence number of event
+
+};
+
+} // end of namespace smf
+
+#endif /* _MIDICOMPACTEVENT_H_INCLUDED */
+
+
+
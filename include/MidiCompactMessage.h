@@ -0,0 +1,139 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 12:31:07 PDT 2026
+// Last Modified: Sat Oct 17 12:31:07 PDT 2026
+// Filename:      midifile/include/MidiCompactMessage.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Storage for the bytes of a MIDI message which keeps
+//                messages of up to eight bytes (all channel messages
+//                as well as tempo, key and time signature meta messages)
+//                inside of the object, and only allocates heap memory
+//                for longer meta and system exclusive messages.  The
+//                object is 16 bytes in size, compared to 24 bytes plus
+//                a heap allocation for MidiMessage.  Provides the most
+//                commonly used parts of the std::vector<uchar> interface
+//                and MidiMessage query functions.
+//
+
+#ifndef _MIDICOMPACTMESSAGE_H_INCLUDED
+#define _MIDICOMPACTMESSAGE_H_INCLUDED
+
+#include "MidiMessage.h"
+
+#include <vector>
+
+
+namespace smf {
+
+class MidiCompactMessage {
+	public:
+		// Number of bytes which can be stored without a heap allocation:
+		static const int INLINE_SIZE = 8;
+
+		                    MidiCompactMessage   (void);
+		                    MidiCompactMessage   (int command);
+		                    MidiCompactMessage   (int command, int p1);
+		                    MidiCompactMessage   (int command, int p1, int p2);
+		                    MidiCompactMessage   (const uchar* data, int count);
+		                    MidiCompactMessage   (const std::vector<uchar>& message);
+		                    MidiCompactMessage   (const MidiCompactMessage& message);
+		                    MidiCompactMessage   (MidiCompactMessage&& message);
+
+		                   ~MidiCompactMessage   ();
+
+		MidiCompactMessage& operator=            (const MidiCompactMessage& message);
+		MidiCompactMessage& operator=            (MidiCompactMessage&& message);
+		MidiCompactMessage& operator=            (const std::vector<uchar>& bytes);
+
+		// std::vector-like interface:
+		size_t              size                 (void) const { return (size_t)m_size; }
+		bool                empty                (void) const { return m_size == 0; }
+		size_t              capacity             (void) const { return (size_t)m_capacity; }
+		uchar*              data                 (void) { return isInline() ? m_inline : m_heap; }
+		const uchar*        data                 (void) const { return isInline() ? m_inline : m_heap; }
+		uchar*              begin                (void) { return data(); }
+		const uchar*        begin                (void) const { return data(); }
+		uchar*              end                  (void) { return data() + m_size; }
+		const uchar*        end                  (void) const { return data() + m_size; }
+		uchar&              operator[]           (int index) { return data()[index]; }
+		const uchar&        operator[]           (int index) const { return data()[index]; }
+		uchar&              back                 (void) { return data()[m_size - 1]; }
+		const uchar&        back                 (void) const { return data()[m_size - 1]; }
+		void                clear                (void) { m_size = 0; }
+		void                reserve              (int count);
+		void                resize               (int count);
+		void                push_back            (uchar value);
+		void                assign               (const uchar* first, const uchar* last);
+
+		// conversion to/from std::vector and MidiMessage storage:
+		int                 getSize              (void) const { return m_size; }
+		bool                isInline             (void) const { return m_capacity <= INLINE_SIZE; }
+		void                setMessage           (const std::vector<uchar>& message);
+		std::vector<uchar>  getMessage           (void) const;
+		void                getMessage           (std::vector<uchar>& message) const;
+		MidiMessage         getMidiMessage       (void) const;
+
+		// data access convenience functions (returns -1 if not present):
+		int                 getP0                (void) const;
+		int                 getP1                (void) const;
+		int                 getP2                (void) const;
+		int                 getP3                (void) const;
+		int                 getCommandNibble     (void) const;
+		int                 getCommandByte       (void) const;
+		int                 getChannelNibble     (void) const;
+		int                 getChannel           (void) const;
+		int                 getKeyNumber         (void) const;
+		int                 getVelocity          (void) const;
+		int                 getControllerNumber  (void) const;
+		int                 getControllerValue   (void) const;
+		int                 getMetaType          (void) const;
+		int                 getTempoMicroseconds (void) const;
+		double              getTempoSPT          (int tpq) const;
+
+		// message-type convenience functions:
+		bool                isMeta               (void) const;
+		bool                isNote               (void) const;
+		bool                isNoteOff            (void) const;
+		bool                isNoteOn             (void) const;
+		bool                isAftertouch         (void) const;
+		bool                isController         (void) const;
+		bool                isSustain            (void) const;
+		bool                isSustainOn          (void) const;
+		bool                isSustainOff         (void) const;
+		bool                isPatchChange        (void) const;
+		bool                isPressure           (void) const;
+		bool                isPitchbend          (void) const;
+		bool                isTempo              (void) const;
+		bool                isEndOfTrack         (void) const;
+
+	protected:
+		// m_inline/m_heap == Storage for the message bytes.  The
+		// bytes are in m_inline when m_capacity is INLINE_SIZE,
+		// otherwise they are in the m_heap allocation.
+		union {
+			uchar  m_inline[INLINE_SIZE];
+			uchar* m_heap;
+		};
+
+		// m_size == The number of bytes in the message.
+		int m_size = 0;
+
+		// m_capacity == The number of bytes which can be stored
+		// without reallocating.
+		int m_capacity = INLINE_SIZE;
+
+};
+
+
+std::ostream& operator<<(std::ostream& out, const MidiCompactMessage& message);
+
+
+} // end of namespace smf
+
+#endif /* _MIDICOMPACTMESSAGE_H_INCLUDED */
+
+
+
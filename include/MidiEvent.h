@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Feb 14 21:47:39 PST 2015
-// Last Modified: Sat Apr 21 10:52:19 PDT 2018 Removed using namespace std;
+// Last Modified: Sun Oct 18 01:12:40 PDT 2026 Added arena block pointer.
 // Filename:      midifile/include/MidiEvent.h
 // Website:       http://midifile.sapp.org
 // Syntax:        C++11
@@ -22,6 +22,8 @@
 
 namespace smf {
 
+class _EventArenaBlock;
+
 class MidiEvent : public MidiMessage {
 	public:
 		           MidiEvent             (void);
@@ -63,8 +65,12 @@ class MidiEvent : public MidiMessage {
 		int        seq;      // sorting sequence number of event
 
 	private:
+		_EventArenaBlock* m_arenaBlock = NULL; // MidiEventArena block of event
 		MidiEvent* m_eventlink;  // used to match note-ons and note-offs
 
+	// MidiEventArena sets m_arenaBlock
+	friend class MidiEventArena;
+
 };
 
 
@@ -0,0 +1,82 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 11:48:30 PDT 2026
+// Last Modified: Sun Oct 18 01:12:40 PDT 2026 Shared block lifetime.
+// Filename:      midifile/include/MidiEventArena.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   A class which allocates MidiEvents in large contiguous
+//                blocks of memory rather than individually on the heap.
+//                Events are still destroyed one at a time by the
+//                MidiEventList which stores them.  Each block counts its
+//                live events, and its memory is released when the arena
+//                has been cleared and the last event in the block has been
+//                destroyed, so events can be moved to MidiEventLists which
+//                outlive the arena.
+//
+
+#ifndef _MIDIEVENTARENA_H_INCLUDED
+#define _MIDIEVENTARENA_H_INCLUDED
+
+#include "MidiEvent.h"
+
+#include <atomic>
+#include <vector>
+
+
+namespace smf {
+
+class _EventArenaBlock {
+	public:
+		std::atomic<int> references;  // live or unused events, plus arena
+		MidiEvent*       events;      // raw storage for MidiEvents
+		int              capacity;    // number of events which fit in block
+};
+
+
+class MidiEventArena {
+	public:
+		                 MidiEventArena     (void);
+		                 MidiEventArena     (MidiEventArena&& other);
+		                 MidiEventArena     (const MidiEventArena& other) = delete;
+
+		                ~MidiEventArena     ();
+
+		MidiEventArena&  operator=          (MidiEventArena&& other);
+		MidiEventArena&  operator=          (const MidiEventArena& other) = delete;
+
+		MidiEvent*       newEvent           (void);
+		void             reserve            (int count);
+		void             append             (MidiEventArena& other);
+		void             clear              (void);
+		int              getEventCount      (void) const;
+
+		static void      deleteEvent        (MidiEvent* event);
+
+	protected:
+		// m_blocks == Memory blocks allocated for events.  New events
+		// are allocated from the last block.
+		std::vector<_EventArenaBlock*> m_blocks;
+
+		// m_used == Number of events allocated from the last block.
+		int m_used = 0;
+
+		// m_count == Total number of events allocated from the arena.
+		int m_count = 0;
+
+	private:
+		void             addBlock           (int capacity);
+		void             retireLastBlock    (void);
+		static void      releaseBlock       (_EventArenaBlock* block,
+		                                     int count);
+
+};
+
+} // end of namespace smf
+
+#endif /* _MIDIEVENTARENA_H_INCLUDED */
+
+
+
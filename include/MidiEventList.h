@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Feb 14 21:55:38 PST 2015
-// Last Modified: Sat Apr 21 10:52:19 PDT 2018 Removed using namespace std;
+// Last Modified: Sat Oct 17 22:18:54 PDT 2026 Radix sort for large lists.
 // Filename:      midifile/include/MidiEventList.h
 // Website:       http://midifile.sapp.org
 // Syntax:        C++11
@@ -15,11 +15,20 @@
 
 #include "MidiEvent.h"
 
+#include <cstdint>
 #include <vector>
 
 
 namespace smf {
 
+class _EventSortKey {
+	public:
+		uint64_t   order;   // tick and sequence number
+		uint64_t   detail;  // end-of-track flag, message category, run and parameters
+		MidiEvent* event;   // event being sorted
+};
+
+
 class MidiEventList {
 	public:
 		                 MidiEventList      (void);
@@ -70,6 +79,17 @@ class MidiEventList {
 		void             sort                   (void) { return sortNoteOnsBeforeOffs(); }
 		void             sortNoteOnsBeforeOffs  (void);
 		void             sortNoteOffsBeforeOns  (void);
+		void             sortEvents             (bool noteOffsFirstQ);
+		void             makeSortKeys           (std::vector<_EventSortKey>& keys,
+		                                         bool noteOffsFirstQ) const;
+		static void      makeSortKey            (_EventSortKey& key, MidiEvent* event,
+		                                         bool noteOffsFirstQ);
+		static void      sortKeys               (std::vector<_EventSortKey>& keys);
+		static void      sortKeysByTick         (std::vector<_EventSortKey>& keys);
+		static void      radixSortKeys          (std::vector<_EventSortKey>& keys);
+		static void      sortTickGroups         (std::vector<_EventSortKey>& keys);
+		static void      sortTickGroup          (_EventSortKey* first,
+		                                         _EventSortKey* last);
 
 	// MidiFile class calls sort()
 	friend class MidiFile;
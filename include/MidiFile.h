@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Fri Nov 26 14:12:01 PST 1999
-// Last Modified: Mon Jan 18 20:54:04 PST 2021 Added readSmf().
+// Last Modified: Sun Oct 18 00:31:17 PDT 2026 Added getFingerprint().
 // Filename:      midifile/include/MidiFile.h
 // Website:       http://midifile.sapp.org
 // Syntax:        C++11
@@ -14,9 +14,14 @@
 #ifndef _MIDIFILE_H_INCLUDED
 #define _MIDIFILE_H_INCLUDED
 
+#include "MidiEventArena.h"
 #include "MidiEventList.h"
+#include "MidiFileError.h"
 
+#include <atomic>
+#include <cstdint>
 #include <fstream>
+#include <functional>
 #include <istream>
 #include <string>
 #include <vector>
@@ -34,10 +39,11 @@ enum {
     TIME_STATE_ABSOLUTE = 1  // MidiMessage::ticks are in absolute time format (0=start time).
 };
 
-class _TickTime {
+class _TempoSegment {
 	public:
-		int    tick;
-		double seconds;
+		int    tick;            // starting tick of the segment
+		double seconds;         // time in seconds at the starting tick
+		double secondsPerTick;  // tempo of the segment
 };
 
 
@@ -59,26 +65,49 @@ class MidiFile {
 		// Auto-detected SMF or ASCII-encoded SMF (decoded with Binasc class):
 		bool           read                        (const std::string& filename);
 		bool           read                        (std::istream& instream);
+		bool           read                        (const uchar* data, size_t size);
 		bool           readBase64                  (const std::string& base64data);
 		bool           readBase64                  (std::istream& instream);
 
 		// Only allow Standard MIDI File input:
 		bool           readSmf                     (const std::string& filename);
 		bool           readSmf                     (std::istream& instream);
-
-		bool           write                       (const std::string& filename);
-		bool           write                       (std::ostream& out);
-		bool           writeBase64                 (const std::string& out, int width = 0);
-		bool           writeBase64                 (std::ostream& out, int width = 0);
-		std::string    getBase64                   (int width = 0);
-		bool           writeHex                    (const std::string& filename, int width = 25);
-		bool           writeHex                    (std::ostream& out, int width = 25);
-		bool           writeBinasc                 (const std::string& filename);
-		bool           writeBinasc                 (std::ostream& out);
-		bool           writeBinascWithComments     (const std::string& filename);
-		bool           writeBinascWithComments     (std::ostream& out);
+		bool           readSmf                     (const uchar* data, size_t size);
+
+		bool           write                       (const std::string& filename) const;
+		bool           write                       (std::ostream& out) const;
+		bool           write                       (uchar* buffer, size_t size) const;
+		bool           write                       (std::vector<uchar>& output) const;
+		size_t         getWriteSize                (void) const;
+		bool           writeBase64                 (const std::string& out, int width = 0) const;
+		bool           writeBase64                 (std::ostream& out, int width = 0) const;
+		std::string    getBase64                   (int width = 0) const;
+		bool           writeHex                    (const std::string& filename, int width = 25) const;
+		bool           writeHex                    (std::ostream& out, int width = 25) const;
+		bool           writeBinasc                 (const std::string& filename) const;
+		bool           writeBinasc                 (std::ostream& out) const;
+		bool           writeBinascWithComments     (const std::string& filename) const;
+		bool           writeBinascWithComments     (std::ostream& out) const;
 		bool           status                      (void) const;
 
+		// reading options:
+		void           setMemoryMap                (bool state);
+		void           setMemoryMapOn              (void);
+		void           setMemoryMapOff             (void);
+		bool           getMemoryMap                (void) const;
+		void           setReadThreads              (int count);
+		int            getReadThreads              (void) const;
+		void           setErrorPrinting            (bool state);
+		void           setErrorPrintingOn          (void);
+		void           setErrorPrintingOff         (void);
+		bool           getErrorPrinting            (void) const;
+		const MidiFileError& getError              (void) const;
+		const std::string& getErrorMessage         (void) const;
+
+		// track processing options:
+		void           setTrackThreads             (int count);
+		int            getTrackThreads             (void) const;
+
 		// track-related functions:
 		const MidiEventList& operator[]            (int aTrack) const;
 		MidiEventList&   operator[]                (int aTrack);
@@ -135,6 +164,7 @@ class MidiFile {
 
 		// physical-time analysis functions:
 		void             doTimeAnalysis            (void);
+		void             updateTimeAnalysis        (void);
 		double           getTimeInSeconds          (int aTrack, int anIndex);
 		double           getTimeInSeconds          (int tickvalue);
 		double           getAbsoluteTickTime       (double starttime);
@@ -149,6 +179,9 @@ class MidiFile {
 		int              linkEventPairs            (void);
 		void             clearLinks                (void);
 
+		// content comparison:
+		uint64_t         getFingerprint            (void) const;
+
 		// filename functions:
 		void             setFilename               (const std::string& aname);
 		const char*      getFilename               (void) const;
@@ -268,6 +301,8 @@ class MidiFile {
 		static std::ostream& writeBigEndianDouble    (std::ostream& out,
 		                                              double value);
 		static std::string   getGMInstrumentName     (int patchIndex);
+		static int           packVLValue             (long aValue, uchar* bytes,
+		                                              bool reportQ = true);
 
 	protected:
 		// m_events == Lists of MidiEvents for each MIDI file track.
@@ -292,36 +327,94 @@ class MidiFile {
 		// the object.
 		std::string m_readFileName;
 
-		// m_timemapvalid ==
-		bool m_timemapvalid = false;
+		// m_timemapdirty == Earliest tick at which m_timemap and the event
+		// times in seconds are out of date (-1 if they are up to date).
+		int m_timemapdirty = 0;
 
-		// m_timemap ==
-		std::vector<_TickTime> m_timemap;
+		// m_timemap == Tempo segments of the file (one for each tempo
+		// change, plus the default tempo at tick 0), sorted by tick.
+		std::vector<_TempoSegment> m_timemap;
 
-		// m_rwstatus == True if last read was successful, false if a problem.
-		bool m_rwstatus = true;
+		// m_rwstatus == True if last read or write was successful, false
+		// if a problem.  Atomic and mutable, since the const write
+		// functions store their status (and can run in several threads).
+		mutable std::atomic<bool> m_rwstatus{true};
 
 		// m_linkedEventQ == True if link analysis has been done.
 		bool m_linkedEventsQ = false;
 
+		// m_memoryMapQ == True if files should be memory mapped when read.
+		bool m_memoryMapQ = false;
+
+		// m_readThreads == Number of threads for decoding tracks
+		// (0 = one per processor core).
+		int m_readThreads = 1;
+
+		// m_trackThreads == Number of threads for per-track operations
+		// such as sorting (0 = one per processor core).
+		int m_trackThreads = 1;
+
+		// m_printErrorsQ == True if read errors are printed to std::cerr.
+		bool m_printErrorsQ = false;
+
+		// m_error == Description of the last read error.
+		MidiFileError m_error;
+
+		// m_arena == Storage for the MidiEvents created when reading
+		// a file.  Released in clear() (memory blocks still holding
+		// events moved out of the MidiFile are freed with the events).
+		MidiEventArena m_arena;
+
 	private:
-		int         extractMidiData                 (std::istream& inputfile,
+		void        readError                       (const MidiFileError& error);
+		bool        readTrackData                   (const uchar*& ptr,
+		                                             const uchar* end,
+		                                             MidiEventList& eventlist,
+		                                             MidiEventArena& arena,
+		                                             int track,
+		                                             MidiFileError& error);
+		int         extractMidiData                 (const uchar*& ptr,
+		                                             const uchar* end,
 		                                             std::vector<uchar>& array,
-		                                             uchar& runningCommand);
-		ulong       readVLValue                     (std::istream& inputfile);
-		ulong       unpackVLV                       (uchar a = 0, uchar b = 0,
-		                                             uchar c = 0, uchar d = 0,
-		                                             uchar e = 0);
-		void        writeVLValue                    (long aValue,
-		                                             std::vector<uchar>& data);
+		                                             uchar& runningCommand,
+		                                             MidiFileError& error);
+		bool        readVLValue                     (const uchar*& ptr,
+		                                             const uchar* end,
+		                                             ulong& value,
+		                                             MidiFileError& error);
+		void        forEachTrack                    (const std::function<void(int)>& function);
+		bool        readTracksParallel              (const uchar* ptr,
+		                                             const uchar* end,
+		                                             int tracks);
+		bool        checkChunkId                    (const uchar*& ptr,
+		                                             const uchar* start,
+		                                             const uchar* end,
+		                                             const char* id,
+		                                             const char* location);
+		static ushort readBigEndian2Bytes           (const uchar*& ptr);
+		static ulong  readBigEndian4Bytes           (const uchar*& ptr);
+		static bool getFileContents                 (const std::string& filename,
+		                                             std::vector<uchar>& buffer);
+		int         readMappedFile                  (const std::string& filename,
+		                                             bool smfQ);
+		size_t      getTrackWriteSizes              (std::vector<ulong>& tracksizes) const;
+		void        writeTracks                     (uchar* buffer,
+		                                             const std::vector<ulong>& tracksizes) const;
+		ulong       writeTrackData                  (int track, uchar* output) const;
+		static void writeBigEndian2Bytes            (uchar*& ptr, ushort value);
+		static void writeBigEndian4Bytes            (uchar*& ptr, ulong value);
 		int         makeVLV                         (uchar *buffer, int number);
-		static int  ticksearch                      (const void* A, const void* B);
-		static int  secondsearch                    (const void* A, const void* B);
 		void        buildTimeMap                    (void);
-		double      linearTickInterpolationAtSecond (double seconds);
-		double      linearSecondInterpolationAtTick (int ticktime);
-		std::string base64Encode                    (const std::string &input);
-		std::string base64Decode                    (const std::string &input);
+		void        updateTrackSeconds              (MidiEventList& eventlist,
+		                                             bool deltaQ,
+		                                             int starttick) const;
+		void        updateEventSeconds              (MidiEvent& event);
+		void        markTimeMapDirty                (int tick);
+		double      linearTickInterpolationAtSecond (double seconds) const;
+		double      linearSecondInterpolationAtTick (int ticktime) const;
+		static uint64_t mixFingerprint              (uint64_t value);
+		static std::string base64Encode             (const std::string &input);
+		static std::string base64Decode             (const std::string &input);
 
 		static const std::string encodeLookup;
 		static const std::vector<int> decodeLookup;
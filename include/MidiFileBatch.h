@@ -0,0 +1,98 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 15:36:44 PDT 2026
+// Last Modified: Sat Oct 17 16:05:12 PDT 2026 Store MidiFileError for each file.
+// Filename:      midifile/include/MidiFileBatch.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Read a list of MIDI files with a pool of worker threads.
+//                Each file is stored in its own MidiFile along with the
+//                read status and error (MidiFileError) for the file.  Nothing
+//                is printed to std::cerr while reading.
+//
+
+#ifndef _MIDIFILEBATCH_H_INCLUDED
+#define _MIDIFILEBATCH_H_INCLUDED
+
+#include "MidiFile.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+
+namespace smf {
+
+class MidiFileBatch {
+	public:
+		typedef std::function<void(int index, MidiFile& midifile, bool status)>
+		        Callback;
+
+		                   MidiFileBatch      (void);
+		                   MidiFileBatch      (const MidiFileBatch& other) = delete;
+		                  ~MidiFileBatch      ();
+
+		MidiFileBatch&     operator=          (const MidiFileBatch& other) = delete;
+
+		// options:
+		void               setThreadCount     (int count);
+		int                getThreadCount     (void) const;
+		void               setKeepFiles       (bool state);
+		void               setKeepFilesOn     (void);
+		void               setKeepFilesOff    (void);
+		bool               getKeepFiles       (void) const;
+		void               setCallback        (Callback callback);
+
+		// reading:
+		bool               read               (const std::vector<std::string>& filenames);
+		void               clear              (void);
+
+		// results:
+		int                getFileCount       (void) const;
+		int                size               (void) const { return getFileCount(); }
+		MidiFile&          getFile            (int index);
+		const MidiFile&    getFile            (int index) const;
+		MidiFile&          operator[]         (int index) { return getFile(index); }
+		const MidiFile&    operator[]         (int index) const { return getFile(index); }
+		bool               getStatus          (int index) const;
+		const std::string& getFilename        (int index) const;
+		const MidiFileError& getError         (int index) const;
+		const std::string& getErrorMessage    (int index) const;
+		int                getErrorCount      (void) const;
+
+	protected:
+		// m_files == One MidiFile for each filename given to read().
+		std::vector<MidiFile*>   m_files;
+
+		// m_filenames == The list of files given to read().
+		std::vector<std::string> m_filenames;
+
+		// m_status == The read status of each file.
+		std::vector<char>        m_status;
+
+		// m_errors == The read error of each file.
+		std::vector<MidiFileError> m_errors;
+
+		// m_threadCount == Number of worker threads (0 = one per core).
+		int m_threadCount = 0;
+
+		// m_keepFilesQ == False if the MidiFile contents are cleared after
+		// the callback has been called (to limit memory use).
+		bool m_keepFilesQ = true;
+
+		// m_callback == Function called from the worker thread after
+		// each file has been read.
+		Callback m_callback;
+
+	private:
+		void               readFile           (int index);
+};
+
+} // end of namespace smf
+
+#endif /* _MIDIFILEBATCH_H_INCLUDED */
+
+
+
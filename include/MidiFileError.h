@@ -0,0 +1,87 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 16:05:12 PDT 2026
+// Last Modified: Sat Oct 17 16:05:12 PDT 2026
+// Filename:      midifile/include/MidiFileError.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Description of a problem found while reading a MIDI
+//                file: an error code, the byte offset in the file where
+//                the problem was found, the track being read, and a
+//                text message.
+//
+
+#ifndef _MIDIFILEERROR_H_INCLUDED
+#define _MIDIFILEERROR_H_INCLUDED
+
+#include <ostream>
+#include <string>
+
+
+namespace smf {
+
+class MidiFileError {
+	public:
+		enum ErrorCode {
+			ERROR_NONE = 0,          // no error
+			ERROR_OPEN,              // file could not be opened
+			ERROR_BAD_INPUT,         // not MIDI or binasc data
+			ERROR_TRUNCATED,         // unexpected end of data
+			ERROR_CHUNK_ID,          // missing "MThd" or "MTrk"
+			ERROR_HEADER_SIZE,       // header chunk is not 6 bytes long
+			ERROR_FILE_TYPE,         // not a type-0 or type-1 file
+			ERROR_TRACK_COUNT,       // type-0 file with multiple tracks
+			ERROR_RUNNING_STATUS,    // running status with no command
+			ERROR_DATA_BYTE,         // data byte larger than 0x7f
+			ERROR_VLV,               // VLV value longer than 5 bytes
+			ERROR_COMMAND_BYTE       // unknown command byte
+		};
+
+		                   MidiFileError    (void);
+		                   MidiFileError    (ErrorCode code,
+		                                     const std::string& message,
+		                                     long offset = -1,
+		                                     int track = -1);
+
+		                  ~MidiFileError    ();
+
+		void               clear            (void);
+		void               setError         (ErrorCode code,
+		                                     const std::string& message);
+		void               setOffset        (long offset);
+		void               setTrack         (int track);
+
+		bool               isError          (void) const;
+		explicit           operator bool    (void) const { return isError(); }
+		ErrorCode          getCode          (void) const;
+		const char*        getCodeName      (void) const;
+		long               getOffset        (void) const;
+		int                getTrack         (void) const;
+		const std::string& getMessage       (void) const;
+
+	protected:
+		// m_code == Type of the error (ERROR_NONE if no error).
+		ErrorCode m_code = ERROR_NONE;
+
+		// m_offset == Byte offset in the file where the error was found
+		// (-1 if not known).
+		long m_offset = -1;
+
+		// m_track == Index of the track being read (-1 if not in a track).
+		int m_track = -1;
+
+		// m_message == Text description of the error.
+		std::string m_message;
+};
+
+
+std::ostream& operator<<(std::ostream& out, const MidiFileError& error);
+
+} // end of namespace smf
+
+#endif /* _MIDIFILEERROR_H_INCLUDED */
+
+
+
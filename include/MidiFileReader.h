@@ -0,0 +1,146 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 17:42:08 PDT 2026
+// Last Modified: Sat Oct 17 17:42:08 PDT 2026
+// Filename:      midifile/include/MidiFileReader.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   A streaming reader for Standard MIDI Files which returns
+//                one event at a time (with absolute ticks) rather than
+//                storing all events of the file in memory.  Events are
+//                read either track by track in file order, or merged
+//                into chronological order across all tracks.  Input
+//                is read through small per-track windows, so memory use
+//                does not depend on the size of the file.
+//
+
+#ifndef _MIDIFILEREADER_H_INCLUDED
+#define _MIDIFILEREADER_H_INCLUDED
+
+#include "MidiEvent.h"
+#include "MidiFileError.h"
+
+#include <fstream>
+#include <istream>
+#include <string>
+#include <vector>
+
+
+namespace smf {
+
+class MidiFileReader {
+	public:
+		                      MidiFileReader         (void);
+		                      MidiFileReader         (const MidiFileReader& other) = delete;
+		                     ~MidiFileReader         ();
+
+		MidiFileReader&       operator=              (const MidiFileReader& other) = delete;
+
+		// options (set before opening input):
+		void                  setMergedOrder         (bool state);
+		void                  setMergedOrderOn       (void);
+		void                  setMergedOrderOff      (void);
+		bool                  getMergedOrder         (void) const;
+
+		bool                  open                   (const std::string& filename);
+		bool                  open                   (std::istream& input);
+		bool                  open                   (const uchar* data, size_t size);
+		void                  close                  (void);
+
+		bool                  readEvent              (MidiEvent& event);
+
+		int                   getFileType            (void) const;
+		int                   getTrackCount          (void) const;
+		int                   getTicksPerQuarterNote (void) const;
+		bool                  status                 (void) const;
+		const MidiFileError&  getError               (void) const;
+
+	protected:
+		class _TrackCursor {
+			public:
+				const uchar*       ptr      = NULL;  // next byte in window
+				const uchar*       stop     = NULL;  // end of window
+				const uchar*       first    = NULL;  // start of window
+				long               offset   = 0;     // file offset of window start
+				long               end      = 0;     // file offset of end of data
+				std::vector<uchar> window;           // buffer for stream input
+				int                tick     = 0;     // absolute tick of last event
+				uchar              running  = 0;     // running status command byte
+				bool               doneQ    = false; // end-of-track has been read
+				MidiEvent          event;            // next event (merged order)
+		};
+
+		// m_data == Input data when reading from a memory buffer.
+		const uchar* m_data = NULL;
+
+		// m_size == Number of bytes in the memory buffer.
+		size_t m_size = 0;
+
+		// m_input == Input stream when reading from a stream.
+		std::istream* m_input = NULL;
+
+		// m_file == File stream used by open(filename).
+		std::ifstream m_file;
+
+		// m_origin == Stream position of the start of the MIDI file
+		// (-1 if the stream is not seekable).
+		std::streamoff m_origin = 0;
+
+		// m_mergedQ == True if events are returned in chronological order.
+		bool m_mergedQ = false;
+
+		// m_main == Cursor for reading the file sequentially (header,
+		// and all tracks in track-by-track order).
+		_TrackCursor m_main;
+
+		// m_tracks == One cursor for each track chunk in merged order.
+		std::vector<_TrackCursor> m_tracks;
+
+		// m_heap == Tracks ordered by the tick of their next event.
+		std::vector<int> m_heap;
+
+		// m_track == Track currently being read in track-by-track order.
+		int m_track = -1;
+
+		// m_type == MIDI file type (0 or 1).
+		int m_type = 0;
+
+		// m_trackCount == Number of tracks in the MIDI file.
+		int m_trackCount = 0;
+
+		// m_ticksPerQuarterNote == Tick resolution of the MIDI file.
+		int m_ticksPerQuarterNote = 0;
+
+		// m_error == Description of the last error.
+		MidiFileError m_error;
+
+	private:
+		bool        openInput                 (void);
+		bool        readHeader                (void);
+		bool        findTracks                (void);
+		bool        startTrack                (_TrackCursor& cursor);
+		bool        readTrackEvent            (_TrackCursor& cursor, int track,
+		                                       MidiEvent& event);
+		bool        readMergedEvent           (MidiEvent& event);
+		bool        fillWindow                (_TrackCursor& cursor);
+		bool        getByte                   (_TrackCursor& cursor, uchar& byte);
+		bool        getBytes                  (_TrackCursor& cursor, ulong count,
+		                                       std::vector<uchar>& output);
+		bool        getVLValue                (_TrackCursor& cursor, ulong& value,
+		                                       int track,
+		                                       std::vector<uchar>* output = NULL);
+		long        getOffset                 (const _TrackCursor& cursor) const;
+		void        setError                  (MidiFileError::ErrorCode code,
+		                                       const std::string& message,
+		                                       long offset, int track = -1);
+		bool        heapCompare               (int a, int b) const;
+};
+
+} // end of namespace smf
+
+#endif /* _MIDIFILEREADER_H_INCLUDED */
+
+
+
@@ -0,0 +1,131 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 18:20:36 PDT 2026
+// Last Modified: Sat Oct 17 18:20:36 PDT 2026
+// Filename:      midifile/include/MidiFileWriter.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   A streaming writer for Standard MIDI Files.  Events are
+//                encoded and written as they are added to the current
+//                track, without storing a MidiFile in memory.  The track
+//                chunk sizes and header track count are filled in
+//                afterwards for seekable outputs.  For non-seekable
+//                outputs, the current track is buffered in memory until
+//                it is finished, and the track count must be given
+//                before the first track is started.
+//
+
+#ifndef _MIDIFILEWRITER_H_INCLUDED
+#define _MIDIFILEWRITER_H_INCLUDED
+
+#include "MidiEvent.h"
+
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+namespace smf {
+
+class MidiFileWriter {
+	public:
+		                MidiFileWriter         (void);
+		                MidiFileWriter         (const MidiFileWriter& other) = delete;
+		               ~MidiFileWriter         ();
+
+		MidiFileWriter& operator=              (const MidiFileWriter& other) = delete;
+
+		bool            open                   (const std::string& filename,
+		                                        int tpq = 120);
+		bool            open                   (std::ostream& out, int tpq = 120);
+		bool            close                  (void);
+
+		void            setTrackCount          (int count);
+		int             getTrackCount          (void) const;
+		int             getTicksPerQuarterNote (void) const;
+
+		bool            startTrack             (void);
+		bool            endTrack               (int tick = -1);
+		bool            addEvent               (int tick, const uchar* data,
+		                                        int size);
+		bool            addEvent               (int tick,
+		                                        const std::vector<uchar>& message);
+		bool            addEvent               (const MidiEvent& event);
+
+		bool            status                 (void) const;
+		const std::string& getErrorMessage     (void) const;
+
+		// options:
+		void            setErrorPrinting       (bool state);
+		void            setErrorPrintingOn     (void);
+		void            setErrorPrintingOff    (void);
+		bool            getErrorPrinting       (void) const;
+
+	protected:
+		// m_out == The output stream.
+		std::ostream* m_out = NULL;
+
+		// m_file == File stream used by open(filename).
+		std::ofstream m_file;
+
+		// m_seekableQ == True if chunk sizes are patched in the output
+		// stream (otherwise each track is buffered in m_buffer).
+		bool m_seekableQ = false;
+
+		// m_headerQ == True if the header chunk has been written.
+		bool m_headerQ = false;
+
+		// m_headerPos == Stream position of the header chunk.
+		std::streampos m_headerPos;
+
+		// m_trackPos == Stream position of the current track chunk.
+		std::streampos m_trackPos;
+
+		// m_trackOpenQ == True if a track has been started and not ended.
+		bool m_trackOpenQ = false;
+
+		// m_trackSize == Number of bytes in the current track chunk data.
+		ulong m_trackSize = 0;
+
+		// m_lastTick == Absolute tick of the last event in the current track.
+		int m_lastTick = 0;
+
+		// m_tracks == Number of tracks started.
+		int m_tracks = 0;
+
+		// m_declaredTracks == Track count given by setTrackCount (-1 if none).
+		int m_declaredTracks = -1;
+
+		// m_ticksPerQuarterNote == Tick resolution written in the header.
+		int m_ticksPerQuarterNote = 120;
+
+		// m_buffer == Data for the current track for non-seekable output.
+		std::vector<uchar> m_buffer;
+
+		// m_rwstatus == False if there was a problem writing.
+		bool m_rwstatus = true;
+
+		// m_errorMessage == Description of the last problem writing.
+		std::string m_errorMessage;
+
+		// m_printErrorsQ == True if errors are printed to std::cerr.
+		bool m_printErrorsQ = false;
+
+	private:
+		bool            openStream             (int tpq);
+		bool            writeHeader            (void);
+		void            output                 (const uchar* data, ulong count);
+		void            outputVLValue          (ulong value);
+		void            writeError             (const std::string& message);
+		static void     storeBigEndian         (uchar* data, ulong value, int count);
+};
+
+} // end of namespace smf
+
+#endif /* _MIDIFILEWRITER_H_INCLUDED */
+
+
+
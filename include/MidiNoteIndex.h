@@ -0,0 +1,111 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 23:41:26 PDT 2026
+// Last Modified: Sat Oct 17 23:41:26 PDT 2026
+// Filename:      midifile/include/MidiNoteIndex.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   An interval index of the notes in a MidiNoteTable for
+//                finding the notes sounding at a given time or during
+//                a time range, in ticks or seconds.  Each query takes
+//                O(log n + k) time for n notes and k results.  A note
+//                sounds from its note-on time up to (but not including)
+//                its note-off time, so notes with no duration (such as
+//                notes without note-offs) are not indexed.
+//
+
+#ifndef _MIDINOTEINDEX_H_INCLUDED
+#define _MIDINOTEINDEX_H_INCLUDED
+
+#include "MidiNoteTable.h"
+
+#include <vector>
+
+
+namespace smf {
+
+class _NoteIntervalNode {
+	public:
+		double center;  // time shared by all intervals in the node
+		int    left;    // child node with intervals before the center (or -1)
+		int    right;   // child node with intervals after the center (or -1)
+		int    first;   // first entry of the node in the byStart/byEnd lists
+		int    count;   // number of intervals in the node
+};
+
+
+class _NoteIntervalTree {
+	public:
+		void   build          (const std::vector<double>& starts,
+		                       const std::vector<double>& ends);
+		void   clear          (void);
+		void   findAt         (std::vector<int>& indexes, double time) const;
+		void   findIn         (std::vector<int>& indexes, double starttime,
+		                       double endtime) const;
+
+	private:
+		int    buildNode      (std::vector<int>& intervals, int first,
+		                       int last);
+
+		// m_start/m_end == Start and end time of each interval.
+		std::vector<double> m_start;
+		std::vector<double> m_end;
+
+		// m_nodes == The tree nodes, with the root node first.
+		std::vector<_NoteIntervalNode> m_nodes;
+
+		// m_byStart == Intervals of each node sorted by increasing
+		// start time.
+		std::vector<int> m_byStart;
+
+		// m_byEnd == Intervals of each node sorted by decreasing end time.
+		std::vector<int> m_byEnd;
+
+		// m_sorted == All intervals sorted by increasing start time.
+		std::vector<int> m_sorted;
+};
+
+
+
+class MidiNoteIndex {
+	public:
+		                MidiNoteIndex          (void);
+		                MidiNoteIndex          (const MidiNoteTable& notes);
+
+		               ~MidiNoteIndex          ();
+
+		void            build                  (const MidiNoteTable& notes);
+		void            clear                  (void);
+		int             getNoteCount           (void) const;
+
+		// queries (store indexes into the MidiNoteTable, not in time order):
+		int             getNotesAtTick         (std::vector<int>& indexes,
+		                                        int tick) const;
+		int             getNotesInTicks        (std::vector<int>& indexes,
+		                                        int starttick, int endtick) const;
+		int             getNotesAtSecond       (std::vector<int>& indexes,
+		                                        double seconds) const;
+		int             getNotesInSeconds      (std::vector<int>& indexes,
+		                                        double startseconds,
+		                                        double endseconds) const;
+
+	protected:
+		// m_ticks == Index of the notes by tick time.
+		_NoteIntervalTree m_ticks;
+
+		// m_seconds == Index of the notes by time in seconds.
+		_NoteIntervalTree m_seconds;
+
+		// m_noteCount == The number of notes in the indexed MidiNoteTable.
+		int m_noteCount = 0;
+
+};
+
+} // end of namespace smf
+
+#endif /* _MIDINOTEINDEX_H_INCLUDED */
+
+
+
@@ -0,0 +1,101 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 23:14:08 PDT 2026
+// Last Modified: Sat Oct 17 23:14:08 PDT 2026
+// Filename:      midifile/include/MidiNoteTable.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   A table of the notes in a MidiFile, with one entry for
+//                each note-on/note-off pair.  Note-ons and note-offs are
+//                paired in FIFO order for each channel and key within a
+//                track (the same pairing as MidiFile::linkNotePairs()).
+//                The pairing uses fixed-size per-channel/key queue arrays,
+//                so no memory is allocated per note.
+//
+
+#ifndef _MIDINOTETABLE_H_INCLUDED
+#define _MIDINOTETABLE_H_INCLUDED
+
+#include "MidiFile.h"
+
+#include <vector>
+
+
+namespace smf {
+
+class MidiNote {
+	public:
+		int    getTickDuration  (void) const { return offTick - onTick; }
+		double getDuration      (void) const { return offSeconds - onSeconds; }
+		bool   isTerminated     (void) const { return offIndex >= 0; }
+
+		// onTick/offTick == Absolute tick times of the note-on and note-off.
+		// Notes without a note-off have offTick equal to onTick.
+		int    onTick;
+		int    offTick;
+
+		// onSeconds/offSeconds == Times in seconds of the note-on and
+		// note-off (0.0 if the time analysis was not done on the MidiFile).
+		double onSeconds;
+		double offSeconds;
+
+		// onIndex/offIndex == Index of the note-on and note-off events in
+		// their track.  offIndex is -1 for notes without a note-off.
+		int    onIndex;
+		int    offIndex;
+
+		// track == Track index of the note in the MidiFile.
+		short  track;
+
+		uchar  key;
+		uchar  channel;
+		uchar  onVelocity;
+		uchar  offVelocity;
+};
+
+
+
+class MidiNoteTable {
+	public:
+		                MidiNoteTable          (void);
+		                MidiNoteTable          (const MidiFile& midifile);
+
+		               ~MidiNoteTable          ();
+
+		void            build                  (const MidiFile& midifile);
+		void            build                  (const MidiEventList& events,
+		                                        int track = 0);
+		void            clear                  (void);
+
+		int             getNoteCount           (void) const;
+		int             size                   (void) const { return getNoteCount(); }
+		int             getUnterminatedCount   (void) const;
+		const MidiNote& getNote                (int index) const;
+		const MidiNote& operator[]             (int index) const;
+		const std::vector<MidiNote>& getNotes  (void) const { return m_notes; }
+
+		void            sortByOnset            (void);
+		int             linkEvents             (MidiFile& midifile) const;
+
+	protected:
+		// m_notes == The note list, ordered by track and then by note-on
+		// position in the track unless sortByOnset() has been called.
+		std::vector<MidiNote> m_notes;
+
+		// m_unterminated == Number of notes without a note-off.
+		int m_unterminated = 0;
+
+	private:
+		void            addTrack               (const MidiEventList& events,
+		                                        int track, bool deltaQ);
+
+};
+
+} // end of namespace smf
+
+#endif /* _MIDINOTETABLE_H_INCLUDED */
+
+
+
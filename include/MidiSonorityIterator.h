@@ -0,0 +1,107 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 00:07:53 PDT 2026
+// Last Modified: Sun Oct 18 00:07:53 PDT 2026
+// Filename:      midifile/include/MidiSonorityIterator.h
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Iterate through the vertical slices (sonorities) of the
+//                notes in a MidiNoteTable.  A new slice starts at every
+//                tick where a note starts or ends, and each slice lists
+//                the notes sounding during it.  The iterator sweeps once
+//                through the note-on and note-off times, so iterating
+//                all slices takes O(n log n) time for n notes.
+//
+
+#ifndef _MIDISONORITYITERATOR_H_INCLUDED
+#define _MIDISONORITYITERATOR_H_INCLUDED
+
+#include "MidiNoteTable.h"
+
+#include <bitset>
+#include <vector>
+
+
+namespace smf {
+
+class MidiSonority {
+	public:
+		int    getTickDuration  (void) const { return endTick - startTick; }
+		double getDuration      (void) const { return endSeconds - startSeconds; }
+		int    getKeyCount      (void) const { return (int)keys.count(); }
+		bool   isRest           (void) const { return notes.empty(); }
+
+		// startTick/endTick == Absolute tick times of the start and end
+		// of the slice.
+		int    startTick = 0;
+		int    endTick   = 0;
+
+		// startSeconds/endSeconds == Times in seconds of the start and end
+		// of the slice (0.0 if the time analysis was not done).
+		double startSeconds = 0.0;
+		double endSeconds   = 0.0;
+
+		// keys == MIDI key numbers sounding during the slice.
+		std::bitset<128> keys;
+
+		// attacks == MIDI key numbers of the notes starting at the slice.
+		std::bitset<128> attacks;
+
+		// notes == Indexes in the MidiNoteTable of the notes sounding
+		// during the slice, in the order that they started.
+		std::vector<int> notes;
+};
+
+
+
+class MidiSonorityIterator {
+	public:
+		                MidiSonorityIterator   (void);
+		                MidiSonorityIterator   (const MidiNoteTable& notes);
+
+		               ~MidiSonorityIterator   ();
+
+		// options (set before start):
+		void            setDrums               (bool state);
+		void            setDrumsOn             (void);
+		void            setDrumsOff            (void);
+		bool            getDrums               (void) const;
+
+		void            start                  (const MidiNoteTable& notes);
+		void            rewind                 (void);
+		bool            next                   (MidiSonority& sonority);
+
+	protected:
+		// m_table == The MidiNoteTable being iterated.
+		const MidiNoteTable* m_table = nullptr;
+
+		// m_drumsQ == True if notes on channel 10 (0x09) are included.
+		bool m_drumsQ = true;
+
+		// m_onsets == Notes sorted by note-on tick.
+		std::vector<int> m_onsets;
+
+		// m_offsets == Notes sorted by note-off tick.
+		std::vector<int> m_offsets;
+
+		// m_nextOnset/m_nextOffset == Position of the next note-on and
+		// note-off in m_onsets and m_offsets.
+		int m_nextOnset = 0;
+		int m_nextOffset = 0;
+
+		// m_active == Notes sounding in the current slice.
+		std::vector<int> m_active;
+
+	private:
+		int             getNextTick            (double& seconds) const;
+
+};
+
+} // end of namespace smf
+
+#endif /* _MIDISONORITYITERATOR_H_INCLUDED */
+
+
+
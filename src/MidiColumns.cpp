@@ -0,0 +1,543 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 13:14:52 PDT 2026
+// Last Modified: Sat Oct 17 14:02:37 PDT 2026 Added vectorized event filtering.
+// Filename:      midifile/src/MidiColumns.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   A read-only snapshot of the events in a MidiFile stored
+//                as parallel arrays for fast analysis loops.
+//
+
+#include "MidiColumns.h"
+
+#include <algorithm>
+
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// MidiColumns::MidiColumns -- Constructor.
+//
+
+MidiColumns::MidiColumns(void) {
+	m_trackStart.push_back(0);
+	m_payloadOffset.push_back(0);
+}
+
+
+MidiColumns::MidiColumns(const MidiFile& midifile) {
+	build(midifile);
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::~MidiColumns -- Deconstructor.
+//
+
+MidiColumns::~MidiColumns() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::build -- Fill the columns with the events of a MidiFile.
+//    Ticks are stored as absolute times even if the MidiFile is in
+//    delta tick mode.  If the tracks are joined, the events are stored
+//    as a single track.
+//
+
+void MidiColumns::build(const MidiFile& midifile) {
+	clear();
+	m_ticksPerQuarterNote = midifile.getTicksPerQuarterNote();
+
+	int tracks = midifile.getTrackCount();
+	int count = 0;
+	for (int i=0; i<tracks; i++) {
+		count += midifile.getEventCount(i);
+	}
+	m_tick.reserve(count);
+	m_seconds.reserve(count);
+	m_track.reserve(count);
+	m_status.reserve(count);
+	m_data1.reserve(count);
+	m_data2.reserve(count);
+	m_payloadOffset.reserve(count + 1);
+	m_trackStart.reserve(tracks + 1);
+
+	bool deltaQ = midifile.isDeltaTicks();
+	for (int i=0; i<tracks; i++) {
+		const MidiEventList& eventlist = midifile[i];
+		int tick = 0;
+		for (int j=0; j<eventlist.size(); j++) {
+			const MidiEvent& event = eventlist[j];
+			if (deltaQ) {
+				tick += event.tick;
+			} else {
+				tick = event.tick;
+			}
+			m_tick.push_back(tick);
+			m_seconds.push_back(event.seconds);
+			m_track.push_back(event.track);
+
+			int length = (int)event.size();
+			int command = length > 0 ? event[0] : 0;
+			int expected = 0;
+			switch (command & 0xf0) {
+				case 0x80: case 0x90: case 0xA0: case 0xB0: case 0xE0:
+					expected = 3;
+					break;
+				case 0xC0: case 0xD0:
+					expected = 2;
+					break;
+			}
+			if ((expected > 0) && (length == expected)) {
+				m_status.push_back((uchar)command);
+				m_data1.push_back(event[1]);
+				m_data2.push_back(expected == 3 ? event[2] : 0);
+			} else {
+				if (command >= 0xf0) {
+					m_status.push_back((uchar)command);
+				} else {
+					m_status.push_back(0x00);
+				}
+				if ((command == 0xff) && (length > 1)) {
+					m_data1.push_back(event[1]);
+				} else {
+					m_data1.push_back(0);
+				}
+				m_data2.push_back(0);
+				m_payload.insert(m_payload.end(), event.begin(), event.end());
+			}
+			m_payloadOffset.push_back((int)m_payload.size());
+		}
+		m_trackStart.push_back((int)m_tick.size());
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::clear -- Remove all events.
+//
+
+void MidiColumns::clear(void) {
+	m_tick.clear();
+	m_seconds.clear();
+	m_track.clear();
+	m_status.clear();
+	m_data1.clear();
+	m_data2.clear();
+	m_payloadOffset.assign(1, 0);
+	m_payload.clear();
+	m_trackStart.assign(1, 0);
+	m_ticksPerQuarterNote = 120;
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::getEventCount -- Return the total number of events
+//     in all tracks.
+//
+
+int MidiColumns::getEventCount(void) const {
+	return (int)m_tick.size();
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::getTrackCount -- Return the number of tracks.
+//
+
+int MidiColumns::getTrackCount(void) const {
+	return (int)m_trackStart.size() - 1;
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::getTrackStart -- Return the index of the first event
+//     of the given track.
+//
+
+int MidiColumns::getTrackStart(int track) const {
+	return m_trackStart[track];
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::getTrackEnd -- Return the index after the last event
+//     of the given track.
+//
+
+int MidiColumns::getTrackEnd(int track) const {
+	return m_trackStart[track + 1];
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::getTicksPerQuarterNote -- Return the ticks per quarter
+//     note of the MidiFile the columns were built from.
+//
+
+int MidiColumns::getTicksPerQuarterNote(void) const {
+	return m_ticksPerQuarterNote;
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::getPayload -- Return the bytes of a meta, system exclusive
+//     or ill-formed message.  Returns NULL for channel messages.
+//
+
+const uchar* MidiColumns::getPayload(int index) const {
+	if (getPayloadSize(index) == 0) {
+		return NULL;
+	}
+	return m_payload.data() + m_payloadOffset[index];
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::getPayloadSize -- Return the number of bytes in the
+//     payload of an event (0 for channel messages).
+//
+
+int MidiColumns::getPayloadSize(int index) const {
+	return m_payloadOffset[index + 1] - m_payloadOffset[index];
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::getMessage -- Reconstruct the bytes of an event.
+//
+
+void MidiColumns::getMessage(int index, std::vector<uchar>& message) const {
+	int length = getPayloadSize(index);
+	if (length > 0) {
+		const uchar* payload = getPayload(index);
+		message.assign(payload, payload + length);
+		return;
+	}
+	int command = m_status[index];
+	message.clear();
+	if (command == 0x00) {
+		// empty message
+		return;
+	}
+	message.push_back((uchar)command);
+	message.push_back(m_data1[index]);
+	if (((command & 0xf0) != 0xC0) && ((command & 0xf0) != 0xD0)) {
+		message.push_back(m_data2[index]);
+	}
+}
+
+
+
+
+//////////////////////////////
+//
+// MidiColumns::findEvents -- Store the indexes of the events which match
+//     ((status & statusMask) == statusValue) and which have data bytes
+//     in the given (inclusive) ranges.  If track is non-negative, then only
+//     search that track.  Returns the number of matching events.
+//
+
+int MidiColumns::findEvents(std::vector<int>& indexes, int statusMask,
+		int statusValue, int minData1, int maxData1, int minData2,
+		int maxData2, int track) const {
+	std::vector<uint64_t> mask;
+	markEvents(mask, statusMask, statusValue, minData1, maxData1, minData2,
+			maxData2, track);
+	return getMaskIndexes(indexes, mask);
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::markEvents -- Similar to findEvents(), but sets a bit for
+//     each matching event in a bitmask (bit i%64 of mask[i/64] for event
+//     index i).  Returns the number of matching events.
+//
+
+int MidiColumns::markEvents(std::vector<uint64_t>& mask, int statusMask,
+		int statusValue, int minData1, int maxData1, int minData2,
+		int maxData2, int track) const {
+	int startindex;
+	int endindex;
+	prepareMask(mask, track, startindex, endindex);
+	matchEvents(mask, startindex, endindex, statusMask, statusValue,
+			minData1, maxData1, minData2, maxData2);
+	return countBits(mask);
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::findNoteOns -- Store the indexes of note-on events (with a
+//     non-zero velocity) on the given channel (0-15, or -1 for all channels)
+//     with keys in the given range.
+//
+
+int MidiColumns::findNoteOns(std::vector<int>& indexes, int channel,
+		int minKey, int maxKey, int track) const {
+	int statusMask = channel < 0 ? 0xf0 : 0xff;
+	int statusValue = channel < 0 ? 0x90 : (0x90 | (channel & 0x0f));
+	return findEvents(indexes, statusMask, statusValue, minKey, maxKey,
+			1, 127, track);
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::findNoteOffs -- Store the indexes of note-off events
+//     (0x80 commands or 0x90 commands with a zero velocity) on the given
+//     channel (0-15, or -1 for all channels) with keys in the given range.
+//
+
+int MidiColumns::findNoteOffs(std::vector<int>& indexes, int channel,
+		int minKey, int maxKey, int track) const {
+	int statusMask = channel < 0 ? 0xf0 : 0xff;
+	int chan = channel < 0 ? 0x00 : (channel & 0x0f);
+	std::vector<uint64_t> mask;
+	int startindex;
+	int endindex;
+	prepareMask(mask, track, startindex, endindex);
+	matchEvents(mask, startindex, endindex, statusMask, 0x80 | chan,
+			minKey, maxKey, 0, 255);
+	matchEvents(mask, startindex, endindex, statusMask, 0x90 | chan,
+			minKey, maxKey, 0, 0);
+	return getMaskIndexes(indexes, mask);
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::findControllers -- Store the indexes of controller events
+//     on the given channel (0-15, or -1 for all channels) for the given
+//     controller number (or -1 for all controllers).
+//
+
+int MidiColumns::findControllers(std::vector<int>& indexes, int channel,
+		int number, int track) const {
+	int statusMask = channel < 0 ? 0xf0 : 0xff;
+	int statusValue = channel < 0 ? 0xB0 : (0xB0 | (channel & 0x0f));
+	int minData1 = number < 0 ? 0 : number;
+	int maxData1 = number < 0 ? 255 : number;
+	return findEvents(indexes, statusMask, statusValue, minData1, maxData1,
+			0, 255, track);
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::findSustainOns -- Store the indexes of sustain-pedal-on
+//     events (controller 64 with a value from 64 to 127).
+//
+
+int MidiColumns::findSustainOns(std::vector<int>& indexes, int channel,
+		int track) const {
+	int statusMask = channel < 0 ? 0xf0 : 0xff;
+	int statusValue = channel < 0 ? 0xB0 : (0xB0 | (channel & 0x0f));
+	return findEvents(indexes, statusMask, statusValue, 64, 64, 64, 127, track);
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::findSustainOffs -- Store the indexes of sustain-pedal-off
+//     events (controller 64 with a value from 0 to 63).
+//
+
+int MidiColumns::findSustainOffs(std::vector<int>& indexes, int channel,
+		int track) const {
+	int statusMask = channel < 0 ? 0xf0 : 0xff;
+	int statusValue = channel < 0 ? 0xB0 : (0xB0 | (channel & 0x0f));
+	return findEvents(indexes, statusMask, statusValue, 64, 64, 0, 63, track);
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::getMaskIndexes -- Convert a bitmask from markEvents() into
+//     a list of event indexes.  Returns the number of indexes.
+//
+
+int MidiColumns::getMaskIndexes(std::vector<int>& indexes,
+		const std::vector<uint64_t>& mask) {
+	indexes.clear();
+	indexes.reserve(countBits(mask));
+	for (int i=0; i<(int)mask.size(); i++) {
+		uint64_t word = mask[i];
+		while (word) {
+#ifdef __GNUC__
+			int bit = __builtin_ctzll(word);
+#else
+			int bit = 0;
+			while (((word >> bit) & 1) == 0) {
+				bit++;
+			}
+#endif
+			indexes.push_back(i * 64 + bit);
+			word &= word - 1;
+		}
+	}
+	return (int)indexes.size();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// MidiColumns::prepareMask -- Size and clear a bitmask for all events,
+//     and calculate the range of events to search for the given track.
+//
+
+void MidiColumns::prepareMask(std::vector<uint64_t>& mask, int track,
+		int& startindex, int& endindex) const {
+	mask.assign((getEventCount() + 63) / 64, 0);
+	if ((track < 0) || (track >= getTrackCount())) {
+		startindex = 0;
+		endindex = track < 0 ? getEventCount() : 0;
+	} else {
+		startindex = getTrackStart(track);
+		endindex = getTrackEnd(track);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::matchEvents -- Set bits in the mask for events in the
+//     given index range which match the status and data byte ranges.
+//     Bits already set in the mask are kept.
+//
+
+void MidiColumns::matchEvents(std::vector<uint64_t>& mask, int startindex,
+		int endindex, int statusMask, int statusValue, int minData1,
+		int maxData1, int minData2, int maxData2) const {
+	minData1 = std::max(0, minData1);
+	minData2 = std::max(0, minData2);
+	maxData1 = std::min(255, maxData1);
+	maxData2 = std::min(255, maxData2);
+	if ((minData1 > maxData1) || (minData2 > maxData2)) {
+		return;
+	}
+	const uchar smask  = (uchar)statusMask;
+	const uchar svalue = (uchar)statusValue;
+	const uchar* status = m_status.data();
+	const uchar* data1  = m_data1.data();
+	const uchar* data2  = m_data2.data();
+	uint64_t* bits = mask.data();
+
+	auto matchScalar = [&](int i) {
+		if (((status[i] & smask) == svalue) &&
+				(data1[i] >= minData1) && (data1[i] <= maxData1) &&
+				(data2[i] >= minData2) && (data2[i] <= maxData2)) {
+			bits[i >> 6] |= (uint64_t)1 << (i & 63);
+		}
+	};
+
+	int i = startindex;
+
+#ifdef __SSE2__
+	// Process 16 events at a time.  Blocks start at multiples of 16 so
+	// that the 16 result bits always fall into a single 64-bit word.
+	while ((i < endindex) && (i & 15)) {
+		matchScalar(i++);
+	}
+	const __m128i vmask   = _mm_set1_epi8((char)smask);
+	const __m128i vvalue  = _mm_set1_epi8((char)svalue);
+	const __m128i vd1min  = _mm_set1_epi8((char)minData1);
+	const __m128i vd1max  = _mm_set1_epi8((char)maxData1);
+	const __m128i vd2min  = _mm_set1_epi8((char)minData2);
+	const __m128i vd2max  = _mm_set1_epi8((char)maxData2);
+	for (; i + 16 <= endindex; i += 16) {
+		__m128i s  = _mm_loadu_si128((const __m128i*)(status + i));
+		__m128i d1 = _mm_loadu_si128((const __m128i*)(data1 + i));
+		__m128i d2 = _mm_loadu_si128((const __m128i*)(data2 + i));
+		__m128i match = _mm_cmpeq_epi8(_mm_and_si128(s, vmask), vvalue);
+		// x is in [min, max] if max(x, min) == x and min(x, max) == x:
+		match = _mm_and_si128(match, _mm_cmpeq_epi8(_mm_max_epu8(d1, vd1min), d1));
+		match = _mm_and_si128(match, _mm_cmpeq_epi8(_mm_min_epu8(d1, vd1max), d1));
+		match = _mm_and_si128(match, _mm_cmpeq_epi8(_mm_max_epu8(d2, vd2min), d2));
+		match = _mm_and_si128(match, _mm_cmpeq_epi8(_mm_min_epu8(d2, vd2max), d2));
+		uint64_t result = (uint64_t)(unsigned)_mm_movemask_epi8(match);
+		if (result) {
+			bits[i >> 6] |= result << (i & 63);
+		}
+	}
+#endif
+
+	for (; i < endindex; i++) {
+		matchScalar(i);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiColumns::countBits -- Return the number of bits set in a mask.
+//
+
+int MidiColumns::countBits(const std::vector<uint64_t>& mask) {
+	int count = 0;
+	for (uint64_t word : mask) {
+#ifdef __GNUC__
+		count += __builtin_popcountll(word);
+#else
+		while (word) {
+			word &= word - 1;
+			count++;
+		}
+#endif
+	}
+	return count;
+}
+
+
+} // end of namespace smf
+
+
+
@@ -0,0 +1,122 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 12:31:07 PDT 2026
+// Last Modified: Sat Oct 17 12:31:07 PDT 2026
+// Filename:      midifile/src/MidiCompactEvent.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   A MidiCompactMessage with the timestamp and track
+//                information of a MidiEvent.
+//
+
+#include "MidiCompactEvent.h"
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// MidiCompactEvent::MidiCompactEvent -- Constructor.
+//
+
+MidiCompactEvent::MidiCompactEvent(void) : MidiCompactMessage() {
+	// do nothing
+}
+
+
+MidiCompactEvent::MidiCompactEvent(int aTime, int aTrack,
+		const std::vector<uchar>& message) : MidiCompactMessage(message) {
+	tick  = aTime;
+	track = aTrack;
+}
+
+
+MidiCompactEvent::MidiCompactEvent(const MidiEvent& event)
+		: MidiCompactMessage(event) {
+	tick    = event.tick;
+	track   = event.track;
+	seconds = event.seconds;
+	seq     = event.seq;
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactEvent::operator= -- Copy the contents of a MidiEvent.
+//
+
+MidiCompactEvent& MidiCompactEvent::operator=(const MidiEvent& event) {
+	setMessage(event);
+	tick    = event.tick;
+	track   = event.track;
+	seconds = event.seconds;
+	seq     = event.seq;
+	return *this;
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactEvent::getMidiEvent -- Convert to a MidiEvent.
+//
+
+void MidiCompactEvent::getMidiEvent(MidiEvent& event) const {
+	event.unlinkEvent();
+	getMessage(event);
+	event.tick    = tick;
+	event.track   = track;
+	event.seconds = seconds;
+	event.seq     = seq;
+}
+
+
+MidiEvent MidiCompactEvent::getMidiEvent(void) const {
+	MidiEvent output;
+	getMidiEvent(output);
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactEvent::fromEventList -- Convert a MidiEventList (such as a
+//    track in a MidiFile) into a list of compact events.
+//
+
+void MidiCompactEvent::fromEventList(std::vector<MidiCompactEvent>& output,
+		const MidiEventList& events) {
+	output.clear();
+	output.reserve(events.size());
+	for (int i=0; i<events.size(); i++) {
+		output.emplace_back(events[i]);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactEvent::toEventList -- Append a list of compact events to
+//    a MidiEventList.
+//
+
+void MidiCompactEvent::toEventList(MidiEventList& output,
+		const std::vector<MidiCompactEvent>& events) {
+	output.reserve(output.size() + (int)events.size());
+	for (auto& item : events) {
+		MidiEvent* event = new MidiEvent;
+		item.getMidiEvent(*event);
+		output.push_back_no_copy(event);
+	}
+}
+
+
+} // end of namespace smf
+
+
+
@@ -0,0 +1,655 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 12:31:07 PDT 2026
+// Last Modified: Sat Oct 17 12:31:07 PDT 2026
+// Filename:      midifile/src/MidiCompactMessage.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Storage for the bytes of a MIDI message which keeps
+//                short messages inside of the object.
+//
+
+#include "MidiCompactMessage.h"
+
+#include <cstring>
+#include <iomanip>
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// MidiCompactMessage::MidiCompactMessage -- Constructor.
+//
+
+MidiCompactMessage::MidiCompactMessage(void) {
+	// do nothing
+}
+
+
+MidiCompactMessage::MidiCompactMessage(int command) {
+	m_inline[0] = (uchar)command;
+	m_size = 1;
+}
+
+
+MidiCompactMessage::MidiCompactMessage(int command, int p1) {
+	m_inline[0] = (uchar)command;
+	m_inline[1] = (uchar)p1;
+	m_size = 2;
+}
+
+
+MidiCompactMessage::MidiCompactMessage(int command, int p1, int p2) {
+	m_inline[0] = (uchar)command;
+	m_inline[1] = (uchar)p1;
+	m_inline[2] = (uchar)p2;
+	m_size = 3;
+}
+
+
+MidiCompactMessage::MidiCompactMessage(const uchar* data, int count) {
+	assign(data, data + count);
+}
+
+
+MidiCompactMessage::MidiCompactMessage(const std::vector<uchar>& message) {
+	setMessage(message);
+}
+
+
+MidiCompactMessage::MidiCompactMessage(const MidiCompactMessage& message) {
+	assign(message.begin(), message.end());
+}
+
+
+MidiCompactMessage::MidiCompactMessage(MidiCompactMessage&& message) {
+	*this = std::move(message);
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::~MidiCompactMessage -- Deconstructor.
+//
+
+MidiCompactMessage::~MidiCompactMessage() {
+	if (!isInline()) {
+		delete [] m_heap;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::operator= --
+//
+
+MidiCompactMessage& MidiCompactMessage::operator=(const MidiCompactMessage& message) {
+	if (this == &message) {
+		return *this;
+	}
+	assign(message.begin(), message.end());
+	return *this;
+}
+
+
+MidiCompactMessage& MidiCompactMessage::operator=(MidiCompactMessage&& message) {
+	if (this == &message) {
+		return *this;
+	}
+	if (!isInline()) {
+		delete [] m_heap;
+	}
+	if (message.isInline()) {
+		std::memcpy(m_inline, message.m_inline, INLINE_SIZE);
+	} else {
+		m_heap = message.m_heap;
+	}
+	m_size = message.m_size;
+	m_capacity = message.m_capacity;
+	message.m_size = 0;
+	message.m_capacity = INLINE_SIZE;
+	return *this;
+}
+
+
+MidiCompactMessage& MidiCompactMessage::operator=(const std::vector<uchar>& bytes) {
+	setMessage(bytes);
+	return *this;
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::reserve -- Make room for at least the given number
+//    of bytes.  Memory is only allocated if the count is larger than
+//    INLINE_SIZE.
+//
+
+void MidiCompactMessage::reserve(int count) {
+	if (count <= m_capacity) {
+		return;
+	}
+	uchar* newdata = new uchar[count];
+	if (m_size > 0) {
+		std::memcpy(newdata, data(), m_size);
+	}
+	if (!isInline()) {
+		delete [] m_heap;
+	}
+	m_heap = newdata;
+	m_capacity = count;
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::resize -- Change the number of bytes in the message.
+//    New bytes are set to 0.
+//
+
+void MidiCompactMessage::resize(int count) {
+	if (count < 0) {
+		count = 0;
+	}
+	reserve(count);
+	if (count > m_size) {
+		std::memset(data() + m_size, 0, count - m_size);
+	}
+	m_size = count;
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::push_back -- Add a byte to the end of the message.
+//
+
+void MidiCompactMessage::push_back(uchar value) {
+	if (m_size >= m_capacity) {
+		reserve(m_capacity * 2);
+	}
+	data()[m_size++] = value;
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::assign -- Replace the message with the given
+//    range of bytes, which must not be inside of this message.
+//
+
+void MidiCompactMessage::assign(const uchar* first, const uchar* last) {
+	int count = (int)(last - first);
+	if (count < 0) {
+		count = 0;
+	}
+	m_size = 0;
+	reserve(count);
+	if (count > 0) {
+		std::memcpy(data(), first, count);
+	}
+	m_size = count;
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::setMessage -- Copy the bytes of a std::vector
+//    (such as a MidiMessage) into the message.
+//
+
+void MidiCompactMessage::setMessage(const std::vector<uchar>& message) {
+	assign(message.data(), message.data() + message.size());
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getMessage -- Return the bytes of the message in
+//    a std::vector, for use with code which expects MidiMessage storage.
+//
+
+std::vector<uchar> MidiCompactMessage::getMessage(void) const {
+	return std::vector<uchar>(begin(), end());
+}
+
+
+void MidiCompactMessage::getMessage(std::vector<uchar>& message) const {
+	message.assign(begin(), end());
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getMidiMessage -- Return a copy of the message
+//    as a MidiMessage.
+//
+
+MidiMessage MidiCompactMessage::getMidiMessage(void) const {
+	MidiMessage output;
+	output.assign(begin(), end());
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getP0 -- Return index 0 byte, or -1 if it doesn't exist.
+//
+
+int MidiCompactMessage::getP0(void) const {
+	return m_size < 1 ? -1 : data()[0];
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getP1 -- Return index 1 byte, or -1 if it doesn't exist.
+//
+
+int MidiCompactMessage::getP1(void) const {
+	return m_size < 2 ? -1 : data()[1];
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getP2 -- Return index 2 byte, or -1 if it doesn't exist.
+//
+
+int MidiCompactMessage::getP2(void) const {
+	return m_size < 3 ? -1 : data()[2];
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getP3 -- Return index 3 byte, or -1 if it doesn't exist.
+//
+
+int MidiCompactMessage::getP3(void) const {
+	return m_size < 4 ? -1 : data()[3];
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getCommandNibble -- Returns the top 4 bits of the
+//    command byte, or -1 if the message is empty.
+//
+
+int MidiCompactMessage::getCommandNibble(void) const {
+	return m_size < 1 ? -1 : (data()[0] & 0xf0);
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getCommandByte -- Return the command byte or -1 if
+//    the message is empty.
+//
+
+int MidiCompactMessage::getCommandByte(void) const {
+	return getP0();
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getChannelNibble -- Returns the bottom 4 bites of
+//      the command byte, or -1 if the message is empty.
+//
+
+int MidiCompactMessage::getChannelNibble(void) const {
+	return m_size < 1 ? -1 : (data()[0] & 0x0f);
+}
+
+
+int MidiCompactMessage::getChannel(void) const {
+	return getChannelNibble();
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getKeyNumber -- Return the key number of a note or
+//    aftertouch message, or -1 for other messages.
+//
+
+int MidiCompactMessage::getKeyNumber(void) const {
+	if (isNote() || isAftertouch()) {
+		return data()[1];
+	} else {
+		return -1;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getVelocity -- Return the key velocity of a note
+//    message, or -1 for other messages.
+//
+
+int MidiCompactMessage::getVelocity(void) const {
+	if (isNote()) {
+		return data()[2];
+	} else {
+		return -1;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getControllerNumber -- Return the controller number
+//    of a controller message, or -1 for other messages.
+//
+
+int MidiCompactMessage::getControllerNumber(void) const {
+	if (isController()) {
+		return data()[1];
+	} else {
+		return -1;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getControllerValue -- Return the controller value
+//    of a controller message, or -1 for other messages.
+//
+
+int MidiCompactMessage::getControllerValue(void) const {
+	if (isController()) {
+		return data()[2];
+	} else {
+		return -1;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getMetaType -- Return the meta-message type, or -1
+//    if not a meta message.
+//
+
+int MidiCompactMessage::getMetaType(void) const {
+	if (!isMeta()) {
+		return -1;
+	} else {
+		return data()[1];
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getTempoMicroseconds -- Returns the number of
+//      microseconds per quarter note if the message is a tempo meta
+//      message, otherwise returns -1.
+//
+
+int MidiCompactMessage::getTempoMicroseconds(void) const {
+	if (!isTempo()) {
+		return -1;
+	}
+	const uchar* bytes = data();
+	return (bytes[3] << 16) + (bytes[4] << 8) + bytes[5];
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::getTempoSPT -- Returns the tempo in terms of seconds
+//      per tick, or -1.0 if not a tempo meta message.
+//
+
+double MidiCompactMessage::getTempoSPT(int tpq) const {
+	int microseconds = getTempoMicroseconds();
+	if (microseconds < 0) {
+		return -1.0;
+	} else {
+		return (double)microseconds / 1000000.0 / tpq;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::isMeta -- Returns true if message is a Meta message
+//      with at least three bytes.
+//
+
+bool MidiCompactMessage::isMeta(void) const {
+	return (m_size >= 3) && (data()[0] == 0xff);
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::isNote -- Returns true if either a note-on or a
+//     note-off message.
+//
+
+bool MidiCompactMessage::isNote(void) const {
+	return isNoteOn() || isNoteOff();
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::isNoteOff -- Returns true if the command nibble is
+//     0x80 or if the command nibble is 0x90 with p2=0 velocity.
+//
+
+bool MidiCompactMessage::isNoteOff(void) const {
+	if (m_size != 3) {
+		return false;
+	}
+	const uchar* bytes = data();
+	if ((bytes[0] & 0xf0) == 0x80) {
+		return true;
+	} else if (((bytes[0] & 0xf0) == 0x90) && (bytes[2] == 0x00)) {
+		return true;
+	} else {
+		return false;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::isNoteOn -- Returns true if the command byte is in
+//    the 0x90 range and the velocity is non-zero.
+//
+
+bool MidiCompactMessage::isNoteOn(void) const {
+	if (m_size != 3) {
+		return false;
+	}
+	const uchar* bytes = data();
+	return ((bytes[0] & 0xf0) == 0x90) && (bytes[2] != 0);
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::isAftertouch -- Returns true if the command byte is
+//    in the 0xA0 range.
+//
+
+bool MidiCompactMessage::isAftertouch(void) const {
+	return (m_size == 3) && ((data()[0] & 0xf0) == 0xA0);
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::isController -- Returns true if the command byte is
+//    in the 0xB0 range and there are two additional data bytes.
+//
+
+bool MidiCompactMessage::isController(void) const {
+	return (m_size == 3) && ((data()[0] & 0xf0) == 0xB0);
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::isSustain -- Returns true if a sustain pedal
+//    (controller 64) message.
+//
+
+bool MidiCompactMessage::isSustain(void) const {
+	return isController() && (data()[1] == 64);
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::isSustainOn -- Returns true if a sustain-pedal-on
+//     control message (value 64-127).
+//
+
+bool MidiCompactMessage::isSustainOn(void) const {
+	return isSustain() && (data()[2] >= 64);
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::isSustainOff -- Returns true if a sustain-pedal-off
+//     control message (value 0-63).
+//
+
+bool MidiCompactMessage::isSustainOff(void) const {
+	return isSustain() && (data()[2] < 64);
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::isPatchChange -- Returns true if the command byte
+//     is in the 0xC0 range and there is one data byte.
+//
+
+bool MidiCompactMessage::isPatchChange(void) const {
+	return (m_size == 2) && ((data()[0] & 0xf0) == 0xC0);
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::isPressure -- Returns true of a channel pressure
+//    message (command nibble 0xd0).
+//
+
+bool MidiCompactMessage::isPressure(void) const {
+	return (m_size == 2) && ((data()[0] & 0xf0) == 0xD0);
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::isPitchbend -- Returns true of a pitch-bend message
+//    (command nibble 0xe0).
+//
+
+bool MidiCompactMessage::isPitchbend(void) const {
+	return (m_size == 3) && ((data()[0] & 0xf0) == 0xE0);
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::isTempo -- Returns true if message is a meta message
+//      describing tempo (meta message type 0x51).
+//
+
+bool MidiCompactMessage::isTempo(void) const {
+	return (m_size == 6) && (data()[0] == 0xff) && (data()[1] == 0x51);
+}
+
+
+
+//////////////////////////////
+//
+// MidiCompactMessage::isEndOfTrack -- Returns true if message is a meta
+//      message for end-of-track (meta message type 0x2f).
+//
+
+bool MidiCompactMessage::isEndOfTrack(void) const {
+	return getMetaType() == 0x2f;
+}
+
+
+
+//////////////////////////////
+//
+// operator<<(MidiCompactMessage) -- Print MIDI messages as text in the
+//    same style as MidiMessage.
+//
+
+std::ostream& operator<<(std::ostream& out, const MidiCompactMessage& message) {
+	for (int i=0; i<message.getSize(); i++) {
+		if (message[i] >= 0x80) {
+			out << "0x" << std::hex << std::setw(2) << std::setfill('0') << (int)message[i];
+			out << std::dec << std::setw(0) << std::setfill(' ');
+		} else {
+			out << (int)message[i];
+		}
+		if (i<message.getSize() - 1) {
+			out << ' ';
+		}
+	}
+	return out;
+}
+
+
+} // end of namespace smf
+
+
+
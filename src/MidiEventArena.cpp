@@ -0,0 +1,265 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 11:48:30 PDT 2026
+// Last Modified: Sun Oct 18 01:12:40 PDT 2026 Shared block lifetime.
+// Filename:      midifile/src/MidiEventArena.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   A class which allocates MidiEvents in large contiguous
+//                blocks of memory rather than individually on the heap.
+//
+
+#include "MidiEventArena.h"
+
+#include <algorithm>
+#include <new>
+#include <utility>
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// MidiEventArena::MidiEventArena -- Constructor.
+//
+
+MidiEventArena::MidiEventArena(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventArena::MidiEventArena(MidiEventArena&&) -- Move constructor.
+//
+
+MidiEventArena::MidiEventArena(MidiEventArena&& other) {
+	*this = std::move(other);
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventArena::~MidiEventArena -- Deconstructor.
+//
+
+MidiEventArena::~MidiEventArena() {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventArena::operator= -- Move the memory blocks of another arena
+//    into this one.  Any blocks already in this arena are released.
+//
+
+MidiEventArena& MidiEventArena::operator=(MidiEventArena&& other) {
+	if (this == &other) {
+		return *this;
+	}
+	clear();
+	m_blocks = std::move(other.m_blocks);
+	m_used   = other.m_used;
+	m_count  = other.m_count;
+	other.m_blocks.clear();
+	other.m_used  = 0;
+	other.m_count = 0;
+	return *this;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventArena::newEvent -- Return a new empty MidiEvent allocated in
+//    the arena.  The event can be stored in a MidiEventList with
+//    MidiEventList::push_back_no_copy(), which will destroy it.
+//
+
+MidiEvent* MidiEventArena::newEvent(void) {
+	if (m_blocks.empty() || (m_used >= m_blocks.back()->capacity)) {
+		addBlock(std::max(1024, m_count));
+	}
+	_EventArenaBlock* block = m_blocks.back();
+	MidiEvent* event = new (block->events + m_used) MidiEvent;
+	event->m_arenaBlock = block;
+	m_used++;
+	m_count++;
+	return event;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventArena::reserve -- Make sure that the next count events
+//    can be allocated from a single block of memory.
+//
+
+void MidiEventArena::reserve(int count) {
+	if (count <= 0) {
+		return;
+	}
+	if (!m_blocks.empty() && (m_blocks.back()->capacity - m_used >= count)) {
+		return;
+	}
+	addBlock(count);
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventArena::append -- Take over the memory blocks of another arena,
+//    so that the events allocated there will remain valid as long as this
+//    arena is not cleared.  The other arena will be empty afterwards.
+//    New events will continue to be allocated from the last block of this
+//    arena.
+//
+
+void MidiEventArena::append(MidiEventArena& other) {
+	if ((this == &other) || other.m_blocks.empty()) {
+		return;
+	}
+	if (m_blocks.empty()) {
+		*this = std::move(other);
+		return;
+	}
+	other.retireLastBlock();
+	m_blocks.insert(m_blocks.end() - 1, other.m_blocks.begin(),
+			other.m_blocks.end());
+	m_count += other.m_count;
+	other.m_blocks.clear();
+	other.m_used  = 0;
+	other.m_count = 0;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventArena::clear -- Release all memory blocks.  Blocks which
+//    still contain events (such as events moved to another MidiEventList
+//    with push_back_no_copy() and detach()) are freed when their last
+//    event is destroyed.
+//
+
+void MidiEventArena::clear(void) {
+	retireLastBlock();
+	for (auto& block : m_blocks) {
+		releaseBlock(block, 1);
+	}
+	m_blocks.clear();
+	m_used  = 0;
+	m_count = 0;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventArena::getEventCount -- Return the number of events which
+//    have been allocated from the arena since it was last cleared.
+//
+
+int MidiEventArena::getEventCount(void) const {
+	return m_count;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventArena::deleteEvent -- Destroy a MidiEvent.  Events allocated
+//    from an arena are destructed, and the memory of their block is freed
+//    if it was the last event in a block of a cleared arena.  Other events
+//    are deleted.
+//
+
+void MidiEventArena::deleteEvent(MidiEvent* event) {
+	if (event == NULL) {
+		return;
+	}
+	_EventArenaBlock* block = event->m_arenaBlock;
+	if (block != NULL) {
+		event->~MidiEvent();
+		releaseBlock(block, 1);
+	} else {
+		delete event;
+	}
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// MidiEventArena::addBlock -- Allocate a new block of memory which can
+//    hold the given number of events.  Any space left in the previous
+//    block is no longer used.  The reference count of the block starts
+//    with one reference for each event slot plus one for the arena, so
+//    that allocating an event does not need to change the count.
+//
+
+void MidiEventArena::addBlock(int capacity) {
+	retireLastBlock();
+	_EventArenaBlock* block = new _EventArenaBlock;
+	block->references = capacity + 1;
+	block->events     = (MidiEvent*)::operator new(capacity * sizeof(MidiEvent));
+	block->capacity   = capacity;
+	m_blocks.push_back(block);
+	m_used = 0;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventArena::retireLastBlock -- Stop allocating events from the last
+//    block, and remove the references of its unused event slots.
+//
+
+void MidiEventArena::retireLastBlock(void) {
+	if (m_blocks.empty()) {
+		return;
+	}
+	_EventArenaBlock* block = m_blocks.back();
+	int unused = block->capacity - m_used;
+	m_used = block->capacity;
+	if (unused > 0) {
+		releaseBlock(block, unused);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventArena::releaseBlock -- Remove references to a block (held by
+//    the arena, by its events or by unused event slots), and free the
+//    block when there are no references left.  Events in a block can be
+//    destroyed from different threads, so the count is atomic.
+//
+
+void MidiEventArena::releaseBlock(_EventArenaBlock* block, int count) {
+	if (block->references.fetch_sub(count, std::memory_order_acq_rel) == count) {
+		::operator delete(block->events);
+		delete block;
+	}
+}
+
+
+} // end of namespace smf
+
+
+
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Feb 14 21:55:38 PST 2015
-// Last Modified: Sat Apr 21 10:52:19 PDT 2018 Removed using namespace std;
+// Last Modified: Sat Oct 17 22:18:54 PDT 2026 Radix sort for large lists.
 // Filename:      midifile/src/MidiEventList.cpp
 // Website:       http://midifile.sapp.org
 // Syntax:        C++11
@@ -11,11 +11,11 @@
 //
 
 #include "MidiEventList.h"
+#include "MidiEventArena.h"
 
 #include <algorithm>
 #include <cstdlib>
 #include <iterator>
-#include <list>
 #include <utility>
 #include <vector>
 
@@ -143,7 +143,7 @@ const MidiEvent& MidiEventList::getEvent(int index) const {
 void MidiEventList::clear(void) {
 	for (auto& item : list) {
 		if (item != NULL) {
-			delete item;
+			MidiEventArena::deleteEvent(item);
 			item = NULL;
 		}
 	}
@@ -247,7 +247,7 @@ void MidiEventList::removeEmpties(void) {
 	int count = 0;
 	for (auto& item : list) {
 		if (item->empty()) {
-			delete item;
+			MidiEventArena::deleteEvent(item);
 			item = NULL;
 			count++;
 		}
@@ -285,15 +285,16 @@ int MidiEventList::linkEventPairs(void) {
 
 
 int MidiEventList::linkNotePairsFIFO(void) {
-	// Note-on states:
-	// dimension 1: MIDI channel (0-15)
-	// dimension 2: MIDI key     (0-127)  (but 0 not used for note-ons)
-	// dimension 3: List of active note-ons or note-offs (FIFO behavior).
-	std::vector<std::vector<std::list<MidiEvent*>>> noteons;
-	noteons.resize(16);
-	for (auto& noteon : noteons) {
-		noteon.resize(128);
-	}
+	// Note-on states: a queue of active note-ons for each MIDI channel
+	// and key (channel * 128 + key), stored as the index of the first
+	// and last note-on in the queue (-1 if empty).  The queues are linked
+	// through nextnoteon, which stores the index of the next note-on in
+	// the same queue (FIFO behavior).
+	int firstnoteon[16 * 128];
+	int lastnoteon[16 * 128];
+	std::fill(firstnoteon, firstnoteon + 16 * 128, -1);
+	std::fill(lastnoteon, lastnoteon + 16 * 128, -1);
+	std::vector<int> nextnoteon(getSize(), -1);
 
 	// Controller linking: The following General MIDI controller numbers are
 	// also monitored for linking within the track (but not between tracks).
@@ -318,7 +319,8 @@ int MidiEventList::linkNotePairsFIFO(void) {
 	// 7A 122   Local Keyboard On/Off                   0..63=off  64..127=on
 
 	// first keep track of whether the controller is an on/off switch:
-	std::vector<std::pair<int, int>> contmap(128, {0, 0});
+	std::pair<int, int> contmap[128];
+	std::fill(contmap, contmap + 128, std::make_pair(0, 0));
 	contmap[64] = {1, 0}; contmap[65] = {1, 1}; contmap[66] = {1, 2}; 
 	contmap[67] = {1, 3}; contmap[68] = {1, 4}; contmap[69] = {1, 5};
 	contmap[80] = {1, 6}; contmap[81] = {1, 7}; contmap[82] = {1, 8}; 
@@ -326,8 +328,10 @@ int MidiEventList::linkNotePairsFIFO(void) {
 	contmap[86] = {1, 12}; contmap[87] = {1, 13}; contmap[88] = {1, 14}; 
 	contmap[89] = {1, 15}; contmap[90] = {1, 16}; contmap[122] = {1, 17};
 
-	std::vector<std::vector<MidiEvent*>> contevents(18, std::vector<MidiEvent*>(16, nullptr));
-	std::vector<std::vector<int>> oldstates(18, std::vector<int>(16, -1));
+	MidiEvent* contevents[18][16];
+	int oldstates[18][16];
+	std::fill(&contevents[0][0], &contevents[0][0] + 18 * 16, nullptr);
+	std::fill(&oldstates[0][0], &oldstates[0][0] + 18 * 16, -1);
 
 	int counter = 0;
 	for (int i = 0; i < getSize(); i++) {
@@ -335,16 +339,22 @@ int MidiEventList::linkNotePairsFIFO(void) {
 		mev->unlinkEvent();
 
 		if (mev->isNoteOn()) {
-			int key = mev->getKeyNumber();
-			int channel = mev->getChannel();
-			noteons[channel][key].push_back(mev);  // Enqueue (FIFO)
+			int slot = mev->getChannel() * 128 + mev->getKeyNumber();
+			if (lastnoteon[slot] < 0) {  // Enqueue (FIFO)
+				firstnoteon[slot] = i;
+			} else {
+				nextnoteon[lastnoteon[slot]] = i;
+			}
+			lastnoteon[slot] = i;
 		} else if (mev->isNoteOff()) {
-			int key = mev->getKeyNumber();
-			int channel = mev->getChannel();
-			if (!noteons[channel][key].empty()) {  // **Check before accessing**
-				MidiEvent* noteon = noteons[channel][key].front(); // Safely access first event
-				noteons[channel][key].pop_front(); // Remove first event (FIFO)
-				noteon->linkEvent(mev);
+			int slot = mev->getChannel() * 128 + mev->getKeyNumber();
+			int index = firstnoteon[slot];
+			if (index >= 0) {
+				firstnoteon[slot] = nextnoteon[index];  // Dequeue (FIFO)
+				if (firstnoteon[slot] < 0) {
+					lastnoteon[slot] = -1;
+				}
+				getEvent(index).linkEvent(mev);
 				counter++;
 			}
 		} else if (mev->isController()) {
@@ -586,6 +596,8 @@ void MidiEventList::detach(void) {
 // MidiEventList::push_back_no_copy -- add a MidiEvent at the end of
 //     the list.  The event is not copied, but memory from the
 //     remote location is used.  Returns the index of the appended event.
+//     The event must have been allocated with new or from a
+//     MidiEventArena, and the list takes over ownership of it.
 //
 
 int MidiEventList::push_back_no_copy(MidiEvent* event) {
@@ -620,11 +632,292 @@ MidiEventList& MidiEventList::operator=(MidiEventList& other) {
 //
 
 void MidiEventList::sortNoteOnsBeforeOffs(void) {
-	qsort(data(), getEventCount(), sizeof(MidiEvent*), MidiEventList::eventCompareNoteOnsBeforeOffs);
+	sortEvents(false);
 }
 
 void MidiEventList::sortNoteOffsBeforeOns(void) {
-	qsort(data(), getEventCount(), sizeof(MidiEvent*), MidiEventList::eventCompareNoteOnsBeforeOffs);
+	sortEvents(true);
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventList::sortEvents -- Sort the events with a stable sort of
+//    their sort keys (see sortKeys()).  Events which compare as equal
+//    stay in their current order.
+//
+
+void MidiEventList::sortEvents(bool noteOffsFirstQ) {
+	std::vector<_EventSortKey> keys;
+	makeSortKeys(keys, noteOffsFirstQ);
+	sortKeys(keys);
+	for (int i=0; i<(int)keys.size(); i++) {
+		list[i] = keys[i].event;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventList::makeSortKeys -- Make a sort key for each event in the
+//    list.
+//
+
+void MidiEventList::makeSortKeys(std::vector<_EventSortKey>& keys,
+		bool noteOffsFirstQ) const {
+	keys.resize(list.size());
+	for (int i=0; i<(int)list.size(); i++) {
+		makeSortKey(keys[i], list[i], noteOffsFirstQ);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventList::makeSortKey -- Pack the sorting rules of
+//    eventCompareNoteOnsBeforeOffs() (or eventCompareNoteOffsBeforeOns()
+//    if noteOffsFirstQ is true) into a key which can be compared as
+//    integers.  The order field contains the tick and then the sequence
+//    number (0 if none).  The detail field contains a flag for
+//    end-of-track messages, the message category (meta, other,
+//    note-on/note-off), a run number for "other" messages (filled in by
+//    sortTickGroup()), and then the key number for notes or the
+//    controller number and value for controllers.
+//
+
+void MidiEventList::makeSortKey(_EventSortKey& key, MidiEvent* event,
+		bool noteOffsFirstQ) {
+	const MidiEvent& me = *event;
+	int p0 = me.getP0();
+	int p1 = me.getP1();
+	uint64_t tick = (uint32_t)me.tick ^ 0x80000000;
+	key.order = (tick << 32) | (uint32_t)me.seq;
+
+	uint64_t category;
+	uint64_t parameters = 0;
+	if (p0 == 0xff) {
+		category = 0;
+	} else if (me.isNoteOn()) {
+		category = noteOffsFirstQ ? 3 : 2;
+		parameters = p1 << 8;
+	} else if (me.isNoteOff()) {
+		category = noteOffsFirstQ ? 2 : 3;
+		parameters = p1 << 8;
+	} else {
+		category = 1;
+		if (((p0 & 0xf0) == 0xb0) && (me.size() >= 3)) {
+			parameters = (p1 << 8) | me.getP2();
+		}
+	}
+	uint64_t eot = ((p0 == 0xff) && (p1 == 0x2f)) ? 1 : 0;
+	key.detail = (eot << 63) | (category << 48) | parameters;
+	key.event = event;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventList::sortKeys -- Stable sort of a list of sort keys: first
+//    by tick, and then each group of keys with the same tick is sorted
+//    with sortTickGroup().
+//
+
+void MidiEventList::sortKeys(std::vector<_EventSortKey>& keys) {
+	sortKeysByTick(keys);
+	sortTickGroups(keys);
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventList::sortKeysByTick -- Stable sort of a list of sort keys
+//    by tick only.  Large lists are sorted with a radix sort.
+//
+
+void MidiEventList::sortKeysByTick(std::vector<_EventSortKey>& keys) {
+	auto tickLess = [](const _EventSortKey& a, const _EventSortKey& b) {
+		return (a.order >> 32) < (b.order >> 32);
+	};
+	if (std::is_sorted(keys.begin(), keys.end(), tickLess)) {
+		return;
+	}
+	if (keys.size() < 4096) {
+		std::stable_sort(keys.begin(), keys.end(), tickLess);
+	} else {
+		radixSortKeys(keys);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventList::radixSortKeys -- Sort the keys by tick with a stable
+//    least-significant-digit radix sort (one counting pass for each byte
+//    of the tick, skipping bytes which are the same for all keys).  This
+//    takes time linear in the number of keys.
+//
+
+void MidiEventList::radixSortKeys(std::vector<_EventSortKey>& keys) {
+	std::vector<_EventSortKey> buffer(keys.size());
+	std::vector<_EventSortKey>* input = &keys;
+	std::vector<_EventSortKey>* output = &buffer;
+	size_t count = keys.size();
+	for (int shift=32; shift<64; shift+=8) {
+		size_t offsets[256] = {0};
+		for (size_t i=0; i<count; i++) {
+			offsets[((*input)[i].order >> shift) & 0xff]++;
+		}
+		if (offsets[((*input)[0].order >> shift) & 0xff] == count) {
+			// all keys have the same value for this byte
+			continue;
+		}
+		size_t sum = 0;
+		for (int j=0; j<256; j++) {
+			size_t value = offsets[j];
+			offsets[j] = sum;
+			sum += value;
+		}
+		for (size_t i=0; i<count; i++) {
+			const _EventSortKey& key = (*input)[i];
+			(*output)[offsets[(key.order >> shift) & 0xff]++] = key;
+		}
+		std::swap(input, output);
+	}
+	if (input != &keys) {
+		keys.swap(buffer);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventList::sortTickGroups -- Sort each group of keys with the same
+//    tick in a list of keys which is already sorted by tick.
+//
+
+void MidiEventList::sortTickGroups(std::vector<_EventSortKey>& keys) {
+	size_t count = keys.size();
+	size_t start = 0;
+	while (start < count) {
+		uint64_t tick = keys[start].order >> 32;
+		size_t end = start + 1;
+		while ((end < count) && ((keys[end].order >> 32) == tick)) {
+			end++;
+		}
+		if (end - start > 1) {
+			sortTickGroup(keys.data() + start, keys.data() + end);
+		}
+		start = end;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventList::sortTickGroup -- Sort the keys of events at the same
+//    tick, following the rules of the comparison functions: sequence
+//    numbers decide when both events have one, and otherwise the detail
+//    field decides.  Events which compare as equal keep their order.
+//
+//    The comparison functions only order controllers against other
+//    controllers (by number and value), and leave other channel messages
+//    in place.  So "other" messages are numbered in runs: the run is
+//    incremented before and after each non-controller message, so that
+//    each one is in a run of its own, and the controllers between them
+//    are sorted within their run.  For example, a program change stays
+//    after the bank-select controllers which come before it.
+//
+//    If only some of the events have sequence numbers, the sequenced
+//    events stay in sequence order, and the other events are sorted
+//    among themselves.  Each of them is then placed before the first
+//    sequenced event with a later category (or a higher key number for
+//    notes), so that a tempo or program change added at the tick of
+//    sequenced notes goes before the notes.  Sorting the result again
+//    does not change it.
+//
+
+void MidiEventList::sortTickGroup(_EventSortKey* first, _EventSortKey* last) {
+	const uint64_t runmask = (uint64_t)0xffffffff << 16;
+	auto detailLess = [](const _EventSortKey& a, const _EventSortKey& b) {
+		return a.detail < b.detail;
+	};
+	auto seqLess = [](const _EventSortKey& a, const _EventSortKey& b) {
+		return (uint32_t)a.order < (uint32_t)b.order;
+	};
+
+	int count = (int)(last - first);
+	int sequenced = 0;
+	for (_EventSortKey* key=first; key<last; key++) {
+		if ((uint32_t)key->order != 0) {
+			sequenced++;
+		}
+	}
+	if (sequenced == count) {
+		if (!std::is_sorted(first, last, seqLess)) {
+			std::stable_sort(first, last, seqLess);
+		}
+		return;
+	}
+
+	_EventSortKey* middle = first;
+	if (sequenced > 0) {
+		middle = std::stable_partition(first, last,
+			[](const _EventSortKey& key) { return (uint32_t)key.order != 0; });
+		std::stable_sort(first, middle, seqLess);
+	}
+
+	uint64_t run = 0;
+	for (_EventSortKey* key=middle; key<last; key++) {
+		if (((key->detail >> 48) & 0x7fff) != 1) {
+			continue;
+		}
+		const MidiEvent& me = *key->event;
+		if (((me.getP0() & 0xf0) == 0xb0) && (me.size() >= 3)) {
+			key->detail = (key->detail & ~runmask) | (run << 16);
+		} else {
+			run++;
+			key->detail = (key->detail & ~runmask) | (run << 16);
+			run++;
+		}
+	}
+	if (!std::is_sorted(middle, last, detailLess)) {
+		std::stable_sort(middle, last, detailLess);
+	}
+	if (sequenced == 0) {
+		return;
+	}
+
+	// Merge the sequenced events with the other events.  Only the
+	// category (and key number of notes) is compared, which is in order
+	// for the sorted events without sequence numbers.
+	auto mergeKey = [](const _EventSortKey& key) {
+		if (((key.detail >> 48) & 0x7fff) == 1) {
+			return key.detail & ~(((uint64_t)1 << 48) - 1);
+		}
+		return key.detail;
+	};
+	std::vector<_EventSortKey> merged;
+	merged.reserve(count);
+	_EventSortKey* s = first;
+	_EventSortKey* u = middle;
+	while ((s < middle) && (u < last)) {
+		if (mergeKey(*u) < mergeKey(*s)) {
+			merged.push_back(*u++);
+		} else {
+			merged.push_back(*s++);
+		}
+	}
+	merged.insert(merged.end(), s, middle);
+	merged.insert(merged.end(), u, last);
+	std::copy(merged.begin(), merged.end(), first);
 }
 
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Fri Nov 26 14:12:01 PST 1999
-// Last Modified: Thu Jun 24 18:35:30 PDT 2021 Added base64 encoding read/write
+// Last Modified: Sun Oct 18 00:31:17 PDT 2026 Added getFingerprint()
 // Filename:      midifile/src/MidiFile.cpp
 // Website:       http://midifile.sapp.org
 // Syntax:        C++11
@@ -16,14 +16,25 @@
 #include "Binasc.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
 
 namespace smf {
 
@@ -128,7 +139,7 @@ MidiFile::~MidiFile() {
 	m_events.resize(0);
 	m_rwstatus = false;
 	m_timemap.clear();
-	m_timemapvalid = 0;
+	m_timemapdirty = 0;
 }
 
 
@@ -153,9 +164,13 @@ MidiFile& MidiFile::operator=(const MidiFile& other) {
 	m_theTrackState       = other.m_theTrackState;
 	m_theTimeState        = other.m_theTimeState;
 	m_readFileName        = other.m_readFileName;
-	m_timemapvalid        = other.m_timemapvalid;
+	m_timemapdirty        = other.m_timemapdirty;
 	m_timemap             = other.m_timemap;
-	m_rwstatus            = other.m_rwstatus;
+	m_rwstatus            = other.m_rwstatus.load();
+	m_memoryMapQ          = other.m_memoryMapQ;
+	m_readThreads         = other.m_readThreads;
+	m_trackThreads        = other.m_trackThreads;
+	m_printErrorsQ        = other.m_printErrorsQ;
 	if (other.m_linkedEventsQ) {
 		linkEventPairs();
 	}
@@ -164,7 +179,13 @@ MidiFile& MidiFile::operator=(const MidiFile& other) {
 
 
 MidiFile& MidiFile::operator=(MidiFile&& other) {
+	if (this == &other) {
+		return *this;
+	}
+	clear();
+	delete m_events[0];
 	m_events = std::move(other.m_events);
+	m_arena = std::move(other.m_arena);
 	m_linkedEventsQ = other.m_linkedEventsQ;
 	other.m_linkedEventsQ = false;
 	other.m_events.clear();
@@ -173,9 +194,13 @@ MidiFile& MidiFile::operator=(MidiFile&& other) {
 	m_theTrackState       = other.m_theTrackState;
 	m_theTimeState        = other.m_theTimeState;
 	m_readFileName        = other.m_readFileName;
-	m_timemapvalid        = other.m_timemapvalid;
+	m_timemapdirty        = other.m_timemapdirty;
 	m_timemap             = other.m_timemap;
-	m_rwstatus            = other.m_rwstatus;
+	m_rwstatus            = other.m_rwstatus.load();
+	m_memoryMapQ          = other.m_memoryMapQ;
+	m_readThreads         = other.m_readThreads;
+	m_trackThreads        = other.m_trackThreads;
+	m_printErrorsQ        = other.m_printErrorsQ;
 	return *this;
 }
 
@@ -193,19 +218,28 @@ MidiFile& MidiFile::operator=(MidiFile&& other) {
 //
 
 bool MidiFile::read(const std::string& filename) {
-	m_timemapvalid = 0;
+	m_timemapdirty = 0;
 	setFilename(filename);
 	m_rwstatus = true;
+	m_error.clear();
 
-	std::fstream input;
-	input.open(filename.c_str(), std::ios::binary | std::ios::in);
+	if (m_memoryMapQ) {
+		int mapstatus = readMappedFile(filename, false);
+		if (mapstatus >= 0) {
+			m_rwstatus = mapstatus ? true : false;
+			return m_rwstatus;
+		}
+	}
 
-	if (!input.is_open()) {
+	std::vector<uchar> buffer;
+	if (!getFileContents(filename, buffer)) {
+		readError(MidiFileError(MidiFileError::ERROR_OPEN,
+				"Error: could not open file " + filename));
 		m_rwstatus = false;
 		return m_rwstatus;
 	}
 
-	m_rwstatus = read(input);
+	m_rwstatus = read(buffer.data(), buffer.size());
 	return m_rwstatus;
 }
 
@@ -215,6 +249,7 @@ bool MidiFile::read(const std::string& filename) {
 
 bool MidiFile::read(std::istream& input) {
 	m_rwstatus = true;
+	m_error.clear();
 	if (input.peek() != 'M') {
 		// If the first byte in the input stream is not 'M', then presume that
 		// the MIDI file is in the binasc format which is an ASCII representation
@@ -225,7 +260,8 @@ bool MidiFile::read(std::istream& input) {
 		binasc.writeToBinary(binarydata, input);
 		binarydata.seekg(0, std::ios_base::beg);
 		if (binarydata.peek() != 'M') {
-			std::cerr << "Bad MIDI data input" << std::endl;
+			readError(MidiFileError(MidiFileError::ERROR_BAD_INPUT,
+					"Bad MIDI data input", 0));
 			m_rwstatus = false;
 			return m_rwstatus;
 		} else {
@@ -238,6 +274,177 @@ bool MidiFile::read(std::istream& input) {
 	}
 }
 
+//
+// Memory buffer version of read().  The data is parsed in place if it
+// starts with 'M', otherwise it is decoded as binasc content.
+//
+
+bool MidiFile::read(const uchar* data, size_t size) {
+	m_rwstatus = true;
+	m_error.clear();
+	if ((size > 0) && (data[0] == 'M')) {
+		m_rwstatus = readSmf(data, size);
+		return m_rwstatus;
+	}
+	std::stringstream input(std::string((const char*)data, size));
+	m_rwstatus = read(input);
+	return m_rwstatus;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::setMemoryMap -- Read files with read(filename) and
+//      readSmf(filename) by mapping them into memory and parsing the
+//      mapping directly, rather than copying the file contents into a
+//      buffer first.  Pipes, devices and other files which cannot be
+//      mapped (as well as all files on Windows) are read normally.
+//      Off by default.
+//
+
+void MidiFile::setMemoryMap(bool state) {
+	m_memoryMapQ = state;
+}
+
+
+void MidiFile::setMemoryMapOn(void) {
+	setMemoryMap(true);
+}
+
+
+void MidiFile::setMemoryMapOff(void) {
+	setMemoryMap(false);
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::getMemoryMap -- Returns true if files are memory mapped
+//      when read.
+//
+
+bool MidiFile::getMemoryMap(void) const {
+	return m_memoryMapQ;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::setReadThreads -- Set the number of threads used to decode
+//      the tracks of a multi-track file in readSmf().  The default of 1
+//      decodes tracks one after another, and 0 uses one thread for each
+//      processor core.  Parallel decoding requires correct track chunk
+//      sizes in the file; otherwise the tracks are read sequentially.
+//
+
+void MidiFile::setReadThreads(int count) {
+	m_readThreads = count < 0 ? 1 : count;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::getReadThreads -- Returns the number of threads used to
+//      decode tracks (0 means one for each processor core).
+//
+
+int MidiFile::getReadThreads(void) const {
+	return m_readThreads;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::setTrackThreads -- Set the number of threads used for
+//      operations which process each track independently: sorting,
+//      linking note pairs, removing empty events, clearing links,
+//      marking and clearing sequence numbers, converting between delta
+//      and absolute ticks, and calculating event times in seconds.  The
+//      default of 1 processes tracks one after another, and 0 uses one
+//      thread for each processor core.  The results do not depend on the
+//      number of threads.
+//
+
+void MidiFile::setTrackThreads(int count) {
+	m_trackThreads = count < 0 ? 1 : count;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::getTrackThreads -- Returns the number of threads used for
+//      per-track operations (0 means one for each processor core).
+//
+
+int MidiFile::getTrackThreads(void) const {
+	return m_trackThreads;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::setErrorPrinting -- Print error messages to std::cerr when
+//      reading a file fails (off by default).  The error is always
+//      available from getError() after a failed read.
+//
+
+void MidiFile::setErrorPrinting(bool state) {
+	m_printErrorsQ = state;
+}
+
+
+void MidiFile::setErrorPrintingOn(void) {
+	setErrorPrinting(true);
+}
+
+
+void MidiFile::setErrorPrintingOff(void) {
+	setErrorPrinting(false);
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::getErrorPrinting -- Returns true if read errors are printed.
+//
+
+bool MidiFile::getErrorPrinting(void) const {
+	return m_printErrorsQ;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::getError -- Returns the error code, byte offset, track and
+//      message of the problem if the last read failed.  The error code
+//      is MidiFileError::ERROR_NONE if the read succeeded.
+//
+
+const MidiFileError& MidiFile::getError(void) const {
+	return m_error;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::getErrorMessage -- Returns the description of the problem
+//      if the last read failed, or an empty string if it succeeded.
+//
+
+const std::string& MidiFile::getErrorMessage(void) const {
+	return m_error.getMessage();
+}
+
 
 
 //////////////////////////////
@@ -269,102 +476,86 @@ bool MidiFile::readBase64(std::istream& instream) {
 //
 
 bool MidiFile::readSmf(const std::string& filename) {
-	m_timemapvalid = 0;
+	m_timemapdirty = 0;
 	setFilename(filename);
 	m_rwstatus = true;
+	m_error.clear();
 
-	std::fstream input;
-	input.open(filename.c_str(), std::ios::binary | std::ios::in);
+	if (m_memoryMapQ) {
+		int mapstatus = readMappedFile(filename, true);
+		if (mapstatus >= 0) {
+			m_rwstatus = mapstatus ? true : false;
+			return m_rwstatus;
+		}
+	}
 
-	if (!input.is_open()) {
+	std::vector<uchar> buffer;
+	if (!getFileContents(filename, buffer)) {
+		readError(MidiFileError(MidiFileError::ERROR_OPEN,
+				"Error: could not open file " + filename));
 		m_rwstatus = false;
 		return m_rwstatus;
 	}
 
-	m_rwstatus = readSmf(input);
+	m_rwstatus = readSmf(buffer.data(), buffer.size());
 	return m_rwstatus;
 }
 
+//
+// istream version of readSmf().  The rest of the stream is read into
+// memory and then parsed with the memory buffer version of readSmf().
+//
 
+bool MidiFile::readSmf(std::istream& input) {
+	m_error.clear();
+	std::vector<uchar> buffer((std::istreambuf_iterator<char>(input)),
+			std::istreambuf_iterator<char>());
+	m_rwstatus = readSmf(buffer.data(), buffer.size());
+	return m_rwstatus;
+}
 
-//////////////////////////////
 //
-// MidiFile::readSmf -- Parse a Standard MIDI File and store its contents in the object.
+// Memory buffer version of readSmf().  The data does not need to
+// remain valid after the function returns.
 //
 
-bool MidiFile::readSmf(std::istream& input) {
+bool MidiFile::readSmf(const uchar* data, size_t size) {
 	m_rwstatus = true;
+	m_error.clear();
 
 	std::string filename = getFilename();
 
-	int    character;
-	// uchar  buffer[123456] = {0};
+	const uchar* ptr = data;
+	const uchar* end = data + size;
 	ulong  longdata;
 	ushort shortdata;
 
 	// Read the MIDI header (4 bytes of ID, 4 byte data size,
 	// anticipated 6 bytes of data.
 
-	character = input.get();
-	if (character == EOF) {
-		std::cerr << "In file " << filename << ": unexpected end of file." << std::endl;
-		std::cerr << "Expecting 'M' at first byte, but found nothing." << std::endl;
-		m_rwstatus = false; return m_rwstatus;
-	} else if (character != 'M') {
-		std::cerr << "File " << filename << " is not a MIDI file" << std::endl;
-		std::cerr << "Expecting 'M' at first byte but got '"
-		     << (char)character << "'" << std::endl;
-		m_rwstatus = false; return m_rwstatus;
-	}
-
-	character = input.get();
-	if (character == EOF) {
-		std::cerr << "In file " << filename << ": unexpected end of file." << std::endl;
-		std::cerr << "Expecting 'T' at second byte, but found nothing." << std::endl;
-		m_rwstatus = false; return m_rwstatus;
-	} else if (character != 'T') {
-		std::cerr << "File " << filename << " is not a MIDI file" << std::endl;
-		std::cerr << "Expecting 'T' at second byte but got '"
-		     << (char)character << "'" << std::endl;
-		m_rwstatus = false; return m_rwstatus;
-	}
-
-	character = input.get();
-	if (character == EOF) {
-		std::cerr << "In file " << filename << ": unexpected end of file." << std::endl;
-		std::cerr << "Expecting 'h' at third byte, but found nothing." << std::endl;
-		m_rwstatus = false; return m_rwstatus;
-	} else if (character != 'h') {
-		std::cerr << "File " << filename << " is not a MIDI file" << std::endl;
-		std::cerr << "Expecting 'h' at third byte but got '"
-		     << (char)character << "'" << std::endl;
+	if (!checkChunkId(ptr, data, end, "MThd", "")) {
 		m_rwstatus = false; return m_rwstatus;
 	}
 
-	character = input.get();
-	if (character == EOF) {
-		std::cerr << "In file " << filename << ": unexpected end of file." << std::endl;
-		std::cerr << "Expecting 'd' at fourth byte, but found nothing." << std::endl;
-		m_rwstatus = false; return m_rwstatus;
-	} else if (character != 'd') {
-		std::cerr << "File " << filename << " is not a MIDI file" << std::endl;
-		std::cerr << "Expecting 'd' at fourth byte but got '"
-		     << (char)character << "'" << std::endl;
+	if (end - ptr < 10) {
+		readError(MidiFileError(MidiFileError::ERROR_TRUNCATED,
+				"In file " + filename + ": unexpected end of file.\n"
+				"Expecting a 14-byte header.", size));
 		m_rwstatus = false; return m_rwstatus;
 	}
 
 	// read header size (allow larger header size?)
-	longdata = readLittleEndian4Bytes(input);
+	longdata = readBigEndian4Bytes(ptr);
 	if (longdata != 6) {
-		std::cerr << "File " << filename
-		     << " is not a MIDI 1.0 Standard MIDI file." << std::endl;
-		std::cerr << "The header size is " << longdata << " bytes." << std::endl;
+		readError(MidiFileError(MidiFileError::ERROR_HEADER_SIZE,
+				"File " + filename + " is not a MIDI 1.0 Standard MIDI file.\n"
+				"The header size is " + std::to_string(longdata) + " bytes.", 4));
 		m_rwstatus = false; return m_rwstatus;
 	}
 
 	// Header parameter #1: format type
 	int type;
-	shortdata = readLittleEndian2Bytes(input);
+	shortdata = readBigEndian2Bytes(ptr);
 	switch (shortdata) {
 		case 0:
 			type = 0;
@@ -376,17 +567,19 @@ bool MidiFile::readSmf(std::istream& input) {
 			// Type-2 MIDI files should probably be allowed as well,
 			// but I have never seen one in the wild to test with.
 		default:
-			std::cerr << "Error: cannot handle a type-" << shortdata
-			     << " MIDI file" << std::endl;
+			readError(MidiFileError(MidiFileError::ERROR_FILE_TYPE,
+					"Error: cannot handle a type-" + std::to_string(shortdata)
+					+ " MIDI file", 8));
 			m_rwstatus = false; return m_rwstatus;
 	}
 
 	// Header parameter #2: track count
 	int tracks;
-	shortdata = readLittleEndian2Bytes(input);
+	shortdata = readBigEndian2Bytes(ptr);
 	if (type == 0 && shortdata != 1) {
-		std::cerr << "Error: Type 0 MIDI file can only contain one track" << std::endl;
-		std::cerr << "Instead track count is: " << shortdata << std::endl;
+		readError(MidiFileError(MidiFileError::ERROR_TRACK_COUNT,
+				"Error: Type 0 MIDI file can only contain one track\n"
+				"Instead track count is: " + std::to_string(shortdata), 10));
 		m_rwstatus = false; return m_rwstatus;
 	} else {
 		tracks = shortdata;
@@ -398,12 +591,10 @@ bool MidiFile::readSmf(std::istream& input) {
 	m_events.resize(tracks);
 	for (int z=0; z<tracks; z++) {
 		m_events[z] = new MidiEventList;
-		m_events[z]->reserve(10000);   // Initialize with 10,000 event storage.
-		m_events[z]->clear();
 	}
 
 	// Header parameter #3: Ticks per quarter note
-	shortdata = readLittleEndian2Bytes(input);
+	shortdata = readBigEndian2Bytes(ptr);
 	if (shortdata >= 0x8000) {
 		int framespersecond = 255 - ((shortdata >> 8) & 0x00ff) + 1;
 		int subframes       = shortdata & 0x00ff;
@@ -413,8 +604,10 @@ bool MidiFile::readSmf(std::istream& input) {
 			case 29:  framespersecond = 29; break;  // really 29.97 for color television
 			case 30:  framespersecond = 30; break;
 			default:
-					std::cerr << "Warning: unknown FPS: " << framespersecond << std::endl;
-					std::cerr << "Using non-standard FPS: " << framespersecond << std::endl;
+					if (m_printErrorsQ) {
+						std::cerr << "Warning: unknown FPS: " << framespersecond << std::endl;
+						std::cerr << "Using non-standard FPS: " << framespersecond << std::endl;
+					}
 		}
 		m_ticksPerQuarterNote = framespersecond * subframes;
 
@@ -431,107 +624,52 @@ bool MidiFile::readSmf(std::istream& input) {
 	// now read individual tracks:
 	//
 
-	uchar runningCommand;
-	MidiEvent event;
-	std::vector<uchar> bytes;
-	int xstatus;
-
-	for (int i=0; i<tracks; i++) {
-		runningCommand = 0;
-
-		// std::cout << "\nReading Track: " << i + 1 << flush;
-
-		// read track header...
+	// Decode the tracks in parallel if requested.  This is only done when
+	// all track chunk sizes are correct, otherwise the tracks are read
+	// one after another below.
+	bool parallelQ = false;
+	if ((m_readThreads != 1) && (tracks > 1)) {
+		parallelQ = readTracksParallel(ptr, end, tracks);
+	}
 
-		character = input.get();
-		if (character == EOF) {
-			std::cerr << "In file " << filename << ": unexpected end of file." << std::endl;
-			std::cerr << "Expecting 'M' at first byte in track, but found nothing."
-			     << std::endl;
-			m_rwstatus = false; return m_rwstatus;
-		} else if (character != 'M') {
-			std::cerr << "File " << filename << " is not a MIDI file" << std::endl;
-			std::cerr << "Expecting 'M' at first byte in track but got '"
-			     << (char)character << "'" << std::endl;
-			m_rwstatus = false; return m_rwstatus;
-		}
+	if (!parallelQ) {
+		// Allocate storage for the events in one block, presuming an
+		// average of four bytes per event.
+		m_arena.reserve((int)((end - ptr) / 4));
 
-		character = input.get();
-		if (character == EOF) {
-			std::cerr << "In file " << filename << ": unexpected end of file." << std::endl;
-			std::cerr << "Expecting 'T' at second byte in track, but found nothing."
-			     << std::endl;
-			m_rwstatus = false; return m_rwstatus;
-		} else if (character != 'T') {
-			std::cerr << "File " << filename << " is not a MIDI file" << std::endl;
-			std::cerr << "Expecting 'T' at second byte in track but got '"
-			     << (char)character << "'" << std::endl;
-			m_rwstatus = false; return m_rwstatus;
-		}
+		for (int i=0; i<tracks; i++) {
 
-		character = input.get();
-		if (character == EOF) {
-			std::cerr << "In file " << filename << ": unexpected end of file." << std::endl;
-			std::cerr << "Expecting 'r' at third byte in track, but found nothing."
-			     << std::endl;
-			m_rwstatus = false; return m_rwstatus;
-		} else if (character != 'r') {
-			std::cerr << "File " << filename << " is not a MIDI file" << std::endl;
-			std::cerr << "Expecting 'r' at third byte in track but got '"
-			     << (char)character << "'" << std::endl;
-			m_rwstatus = false; return m_rwstatus;
-		}
+			// read track header...
 
-		character = input.get();
-		if (character == EOF) {
-			std::cerr << "In file " << filename << ": unexpected end of file." << std::endl;
-			std::cerr << "Expecting 'k' at fourth byte in track, but found nothing."
-			     << std::endl;
-			m_rwstatus = false; return m_rwstatus;
-		} else if (character != 'k') {
-			std::cerr << "File " << filename << " is not a MIDI file" << std::endl;
-			std::cerr << "Expecting 'k' at fourth byte in track but got '"
-			     << (char)character << "'" << std::endl;
-			m_rwstatus = false; return m_rwstatus;
-		}
+			if (!checkChunkId(ptr, data, end, "MTrk", " in track")) {
+				m_rwstatus = false; return m_rwstatus;
+			}
 
-		// Now read track chunk size and throw it away because it is
-		// not really necessary since the track MUST end with an
-		// end of track meta event, and many MIDI files found in the wild
-		// do not correctly give the track size.
-		longdata = readLittleEndian4Bytes(input);
-
-		// Set the size of the track allocation so that it might
-		// approximately fit the data.
-		m_events[i]->reserve((int)longdata/2);
-		m_events[i]->clear();
-
-		// Read MIDI events in the track, which are pairs of VLV values
-		// and then the bytes for the MIDI message.  Running status messages
-		// will be filled in with their implicit command byte.
-		// The timestamps are converted from delta ticks to absolute ticks,
-		// with the absticks variable accumulating the VLV tick values.
-		int absticks = 0;
-		while (!input.eof()) {
-			longdata = readVLValue(input);
-			absticks += longdata;
-			xstatus = extractMidiData(input, bytes, runningCommand);
-			if (xstatus == 0) {
+			if (end - ptr < 4) {
+				readError(MidiFileError(MidiFileError::ERROR_TRUNCATED,
+						"In file " + filename + ": unexpected end of file.\n"
+						"Expecting track chunk size, but found nothing.",
+						ptr - data, i));
 				m_rwstatus = false; return m_rwstatus;
 			}
-			event.setMessage(bytes);
-			event.tick = absticks;
-			event.track = i;
-
-			if (bytes[0] == 0xff && bytes[1] == 0x2f) {
-				// end-of-track message
-				// comment out the following line if you don't want to see the
-				// end of track message (which is always required, and will added
-				// automatically when a MIDI is written, so it is not necessary.
-				m_events[i]->push_back(event);
-				break;
+
+			// Now read track chunk size and throw it away because it is
+			// not really necessary since the track MUST end with an
+			// end of track meta event, and many MIDI files found in the wild
+			// do not correctly give the track size.
+			longdata = readBigEndian4Bytes(ptr);
+
+			// Set the size of the track allocation so that it might
+			// approximately fit the data.
+			m_events[i]->reserve((int)std::min(longdata, (ulong)(end - ptr))/2);
+
+			MidiFileError error;
+			if (!readTrackData(ptr, end, *m_events[i], m_arena, i, error)) {
+				error.setOffset(ptr - data);
+				error.setTrack(i);
+				readError(error);
+				m_rwstatus = false; return m_rwstatus;
 			}
-			m_events[i]->push_back(event);
 		}
 	}
 
@@ -553,126 +691,71 @@ bool MidiFile::readSmf(std::istream& input) {
 //    stream.
 //
 
-bool MidiFile::write(const std::string& filename) {
+bool MidiFile::write(const std::string& filename) const {
 	std::fstream output(filename.c_str(), std::ios::binary | std::ios::out);
 
 	if (!output.is_open()) {
 		std::cerr << "Error: could not write: " << filename << std::endl;
 		return false;
 	}
-	m_rwstatus = write(output);
+	bool status = write(output);
 	output.close();
-	return m_rwstatus;
+	m_rwstatus = status;
+	return status;
 }
 
 //
-// ostream version of MidiFile::write().
+// ostream version of MidiFile::write().  The file is serialized into
+// memory and then written to the stream in one step.  The writing
+// functions do not modify the MidiFile (delta ticks are calculated
+// while writing), so several threads can write the same MidiFile.
 //
 
-bool MidiFile::write(std::ostream& out) {
-	int oldTimeState = getTickState();
-	if (oldTimeState == TIME_STATE_ABSOLUTE) {
-		makeDeltaTicks();
-	}
-
-	// write the header of the Standard MIDI File
-	char ch;
-	// 1. The characters "MThd"
-	ch = 'M'; out << ch;
-	ch = 'T'; out << ch;
-	ch = 'h'; out << ch;
-	ch = 'd'; out << ch;
-
-	// 2. write the size of the header (always a "6" stored in unsigned long
-	//    (4 bytes).
-	ulong longdata = 6;
-	writeBigEndianULong(out, longdata);
-
-	// 3. MIDI file format, type 0, 1, or 2
-	ushort shortdata;
-	shortdata = static_cast<ushort>(getNumTracks() == 1 ? 0 : 1);
-	writeBigEndianUShort(out,shortdata);
-
-	// 4. write out the number of tracks.
-	shortdata = static_cast<ushort>(getNumTracks());
-	writeBigEndianUShort(out, shortdata);
+bool MidiFile::write(std::ostream& out) const {
+	std::vector<uchar> data;
+	write(data);
+	out.write((const char*)data.data(), data.size());
+	return true;
+}
 
-	// 5. write out the number of ticks per quarternote. (avoiding SMPTE for now)
-	shortdata = static_cast<ushort>(getTicksPerQuarterNote());
-	writeBigEndianUShort(out, shortdata);
+//
+// Memory buffer version of MidiFile::write().  The buffer must contain
+// at least getWriteSize() bytes, otherwise nothing is written and false
+// is returned.
+//
 
-	// now write each track.
-	std::vector<uchar> trackdata;
-	uchar endoftrack[4] = {0, 0xff, 0x2f, 0x00};
-	int i, j, k;
-	int size;
-	for (i=0; i<getNumTracks(); i++) {
-		trackdata.reserve(123456);   // make the track data larger than
-		                             // expected data input
-		trackdata.clear();
-		for (j=0; j<(int)m_events[i]->size(); j++) {
-			if ((*m_events[i])[j].empty()) {
-				// Don't write empty m_events (probably a delete message).
-				continue;
-			}
-			if ((*m_events[i])[j].isEndOfTrack()) {
-				// Suppress end-of-track meta messages (one will be added
-				// automatically after all track data has been written).
-				continue;
-			}
-			writeVLValue((*m_events[i])[j].tick, trackdata);
-			if (((*m_events[i])[j].getCommandByte() == 0xf0) ||
-					((*m_events[i])[j].getCommandByte() == 0xf7)) {
-				// 0xf0 == Complete sysex message (0xf0 is part of the raw MIDI).
-				// 0xf7 == Raw byte message (0xf7 not part of the raw MIDI).
-				// Print the first byte of the message (0xf0 or 0xf7), then
-				// print a VLV length for the rest of the bytes in the message.
-				// In other words, when creating a 0xf0 or 0xf7 MIDI message,
-				// do not insert the VLV byte length yourself, as this code will
-				// do it for you automatically.
-				trackdata.push_back((*m_events[i])[j][0]); // 0xf0 or 0xf7;
-				writeVLValue(((int)(*m_events[i])[j].size())-1, trackdata);
-				for (k=1; k<(int)(*m_events[i])[j].size(); k++) {
-					trackdata.push_back((*m_events[i])[j][k]);
-				}
-			} else {
-				// non-sysex type of message, so just output the
-				// bytes of the message:
-				for (k=0; k<(int)(*m_events[i])[j].size(); k++) {
-					trackdata.push_back((*m_events[i])[j][k]);
-				}
-			}
-		}
-		size = (int)trackdata.size();
-		if ((size < 3) || !((trackdata[size-3] == 0xff)
-				&& (trackdata[size-2] == 0x2f))) {
-			trackdata.push_back(endoftrack[0]);
-			trackdata.push_back(endoftrack[1]);
-			trackdata.push_back(endoftrack[2]);
-			trackdata.push_back(endoftrack[3]);
-		}
+bool MidiFile::write(uchar* buffer, size_t size) const {
+	std::vector<ulong> tracksizes;
+	if (getTrackWriteSizes(tracksizes) > size) {
+		return false;
+	}
+	writeTracks(buffer, tracksizes);
+	return true;
+}
 
-		// now ready to write to MIDI file.
+//
+// vector version of MidiFile::write().  The vector is resized to
+// exactly fit the file.
+//
 
-		// first write the track ID marker "MTrk":
-		ch = 'M'; out << ch;
-		ch = 'T'; out << ch;
-		ch = 'r'; out << ch;
-		ch = 'k'; out << ch;
+bool MidiFile::write(std::vector<uchar>& output) const {
+	std::vector<ulong> tracksizes;
+	output.resize(getTrackWriteSizes(tracksizes));
+	writeTracks(output.data(), tracksizes);
+	return true;
+}
 
-		// A. write the size of the MIDI data to follow:
-		longdata = (int)trackdata.size();
-		writeBigEndianULong(out, longdata);
 
-		// B. write the actual data
-		out.write((char*)trackdata.data(), trackdata.size());
-	}
 
-	if (oldTimeState == TIME_STATE_ABSOLUTE) {
-		makeAbsoluteTicks();
-	}
+//////////////////////////////
+//
+// MidiFile::getWriteSize -- Return the number of bytes in the Standard
+//    MIDI file which write() will create.
+//
 
-	return true;
+size_t MidiFile::getWriteSize(void) const {
+	std::vector<ulong> tracksizes;
+	return getTrackWriteSizes(tracksizes);
 }
 
 
@@ -685,20 +768,21 @@ bool MidiFile::write(std::ostream& out) {
 //    Default value: width = 0
 //
 
-bool MidiFile::writeBase64(const std::string& filename, int width) {
+bool MidiFile::writeBase64(const std::string& filename, int width) const {
 	std::fstream output(filename.c_str(), std::ios::binary | std::ios::out);
 
 	if (!output.is_open()) {
 		std::cerr << "Error: could not write: " << filename << std::endl;
 		return false;
 	}
-	m_rwstatus = writeBase64(output, width);
+	bool status = writeBase64(output, width);
 	output.close();
-	return m_rwstatus;
+	m_rwstatus = status;
+	return status;
 }
 
 
-bool MidiFile::writeBase64(std::ostream& out, int width) {
+bool MidiFile::writeBase64(std::ostream& out, int width) const {
 	std::stringstream raw;
 	bool status = MidiFile::write(raw);
 	if (!status) {
@@ -730,7 +814,7 @@ bool MidiFile::writeBase64(std::ostream& out, int width) {
 //     Default value: width = 0
 //
 
-std::string MidiFile::getBase64(int width) {
+std::string MidiFile::getBase64(int width) const {
 	std::stringstream output;
 	bool status = MidiFile::writeBase64(output, width);
 	if (!status) {
@@ -752,22 +836,23 @@ std::string MidiFile::getBase64(int width) {
 //  default value: width=25
 //
 
-bool MidiFile::writeHex(const std::string& filename, int width) {
+bool MidiFile::writeHex(const std::string& filename, int width) const {
 	std::fstream output(filename.c_str(), std::ios::out);
 	if (!output.is_open()) {
 		std::cerr << "Error: could not write: " << filename << std::endl;
 		return false;
 	}
-	m_rwstatus = writeHex(output, width);
+	bool status = writeHex(output, width);
 	output.close();
-	return m_rwstatus;
+	m_rwstatus = status;
+	return status;
 }
 
 //
 // ostream version of MidiFile::writeHex().
 //
 
-bool MidiFile::writeHex(std::ostream& out, int width) {
+bool MidiFile::writeHex(std::ostream& out, int width) const {
 	std::stringstream tempstream;
 	MidiFile::write(tempstream);
 	int len = (int)tempstream.str().length();
@@ -802,26 +887,28 @@ bool MidiFile::writeHex(std::ostream& out, int width) {
 //    the binasc format (ASCII version of the MIDI file).
 //
 
-bool MidiFile::writeBinasc(const std::string& filename) {
+bool MidiFile::writeBinasc(const std::string& filename) const {
 	std::fstream output(filename.c_str(), std::ios::out);
 
 	if (!output.is_open()) {
 		std::cerr << "Error: could not write: " << filename << std::endl;
 		return false;
 	}
-	m_rwstatus = writeBinasc(output);
+	bool status = writeBinasc(output);
 	output.close();
-	return m_rwstatus;
+	m_rwstatus = status;
+	return status;
 }
 
 //
 // ostream version of MidiFile::writeBinasc().
 //
 
-bool MidiFile::writeBinasc(std::ostream& output) {
+bool MidiFile::writeBinasc(std::ostream& output) const {
 	std::stringstream binarydata;
-	m_rwstatus = write(binarydata);
-	if (m_rwstatus == false) {
+	bool status = write(binarydata);
+	m_rwstatus = status;
+	if (!status) {
 		return false;
 	}
 
@@ -841,26 +928,28 @@ bool MidiFile::writeBinasc(std::ostream& output) {
 //    of the MIDI file), including commentary about the MIDI messages.
 //
 
-bool MidiFile::writeBinascWithComments(const std::string& filename) {
+bool MidiFile::writeBinascWithComments(const std::string& filename) const {
 	std::fstream output(filename.c_str(), std::ios::out);
 
 	if (!output.is_open()) {
 		std::cerr << "Error: could not write: " << filename << std::endl;
 		return 0;
 	}
-	m_rwstatus = writeBinascWithComments(output);
+	bool status = writeBinascWithComments(output);
 	output.close();
-	return m_rwstatus;
+	m_rwstatus = status;
+	return status;
 }
 
 //
 // ostream version of MidiFile::writeBinascWithComments().
 //
 
-bool MidiFile::writeBinascWithComments(std::ostream& output) {
+bool MidiFile::writeBinascWithComments(std::ostream& output) const {
 	std::stringstream binarydata;
-	m_rwstatus = write(binarydata);
-	if (m_rwstatus == false) {
+	bool status = write(binarydata);
+	m_rwstatus = status;
+	if (!status) {
 		return false;
 	}
 
@@ -939,9 +1028,9 @@ int MidiFile::size(void) const {
 //
 
 void MidiFile::removeEmpties(void) {
-	for (auto &event : m_events) {
-		event->removeEmpties();
-	}
+	forEachTrack([&](int track) {
+		m_events[track]->removeEmpties();
+	});
 }
 
 
@@ -960,10 +1049,15 @@ void MidiFile::removeEmpties(void) {
 //
 
 void MidiFile::markSequence(void) {
-	int sequence = 1;
+	std::vector<int> sequence(getTrackCount());
+	int next = 1;
 	for (int i=0; i<getTrackCount(); i++) {
-		sequence = operator[](i).markSequence(sequence);
+		sequence[i] = next;
+		next += operator[](i).getEventCount();
 	}
+	forEachTrack([&](int track) {
+		operator[](track).markSequence(sequence[track]);
+	});
 }
 
 //
@@ -989,9 +1083,9 @@ void MidiFile::markSequence(int track, int sequence) {
 //
 
 void MidiFile::clearSequence(void) {
-	for (int i=0; i<getTrackCount(); i++) {
-		operator[](i).clearSequence();
-	}
+	forEachTrack([&](int track) {
+		operator[](track).clearSequence();
+	});
 }
 
 
@@ -1013,7 +1107,11 @@ void MidiFile::clearSequence(int track) {
 //   tracks into separate units again.  The style of the
 //   MidiFile when read from a file is with tracks split.
 //   The original track index is stored in the MidiEvent::track
-//   variable.
+//   variable.  The tracks are sorted by tick individually (if they are
+//   not already in order), and then merged into a single list, which
+//   takes O(N log K) comparisons for N events in K tracks.  The events
+//   at each tick are then sorted, so the result is the same as
+//   appending the tracks and calling sortTracks().
 //
 
 void MidiFile::joinTracks(void) {
@@ -1030,7 +1128,7 @@ void MidiFile::joinTracks(void) {
 
 	int messagesum = 0;
 	int length = getNumTracks();
-	int i, j;
+	int i;
 	for (i=0; i<length; i++) {
 		messagesum += (*m_events[i]).size();
 	}
@@ -1040,18 +1138,122 @@ void MidiFile::joinTracks(void) {
 	if (oldTimeState == TIME_STATE_DELTA) {
 		makeAbsoluteTicks();
 	}
+
+	// Make sort keys for the events of all tracks (in one array, so that
+	// they can be compared during the merge without accessing the events
+	// of every track in turn), and sort by tick any track which is not
+	// in order:
+	std::vector<_EventSortKey> keys;
+	std::vector<_EventSortKey> trackkeys;
+	keys.reserve(messagesum);
+	int leaves = 1;
+	while (leaves < length) {
+		leaves *= 2;
+	}
+	std::vector<int> position(leaves, 0);
+	std::vector<int> stop(leaves, 0);
 	for (i=0; i<length; i++) {
-		for (j=0; j<(int)m_events[i]->size(); j++) {
-			joinedTrack->push_back_no_copy(&(*m_events[i])[j]);
+		m_events[i]->makeSortKeys(trackkeys, false);
+		MidiEventList::sortKeysByTick(trackkeys);
+		position[i] = (int)keys.size();
+		keys.insert(keys.end(), trackkeys.begin(), trackkeys.end());
+		stop[i] = (int)keys.size();
+	}
+
+	// Merge the tracks with a tournament tree (a heap which stores the
+	// track with the later event at each node), so that only one path
+	// from a leaf to the root is compared for each event.
+	auto laterTrack = [&](int a, int b) {
+		bool adoneQ = position[a] == stop[a];
+		bool bdoneQ = position[b] == stop[b];
+		if (adoneQ || bdoneQ) {
+			return adoneQ && (!bdoneQ || (a > b));
+		}
+		const _EventSortKey& akey = keys[position[a]];
+		const _EventSortKey& bkey = keys[position[b]];
+		if (akey.order != bkey.order) {
+			return akey.order > bkey.order;
+		}
+		return a > b;
+	};
+
+	// The events at each tick are collected in group (as indexes into
+	// keys, which are in track order), and then sorted as sortTracks()
+	// would sort the tracks appended into one list.  Groups of sequenced
+	// events are usually already in sequence order from the merge.
+	std::vector<int> group;
+	std::vector<_EventSortKey> groupkeys;
+	auto appendGroup = [&]() {
+		bool sortedQ = true;
+		for (int k=0; k<(int)group.size(); k++) {
+			uint64_t order = keys[group[k]].order;
+			if (((uint32_t)order == 0) ||
+					((k > 0) && (order < keys[group[k-1]].order))) {
+				sortedQ = false;
+				break;
+			}
+		}
+		if (sortedQ) {
+			for (int index : group) {
+				joinedTrack->push_back_no_copy(keys[index].event);
+			}
+			group.clear();
+			return;
+		}
+		std::sort(group.begin(), group.end());
+		groupkeys.clear();
+		for (int index : group) {
+			groupkeys.push_back(keys[index]);
+		}
+		MidiEventList::sortTickGroup(groupkeys.data(),
+				groupkeys.data() + groupkeys.size());
+		for (const _EventSortKey& key : groupkeys) {
+			joinedTrack->push_back_no_copy(key.event);
+		}
+		group.clear();
+	};
+
+	std::vector<int> winners(2 * leaves);
+	std::vector<int> losers(leaves);
+	for (i=0; i<leaves; i++) {
+		winners[leaves + i] = i;
+	}
+	for (i=leaves-1; i>0; i--) {
+		int left  = winners[2 * i];
+		int right = winners[2 * i + 1];
+		if (laterTrack(left, right)) {
+			losers[i] = left;
+			winners[i] = right;
+		} else {
+			losers[i] = right;
+			winners[i] = left;
+		}
+	}
+	int winner = winners[1];
+	uint64_t grouptick = 0;
+	while (position[winner] != stop[winner]) {
+		int index = position[winner]++;
+		uint64_t tick = keys[index].order >> 32;
+		if (!group.empty() && (tick != grouptick)) {
+			appendGroup();
+		}
+		grouptick = tick;
+		group.push_back(index);
+		for (int node=(leaves + winner)/2; node>0; node/=2) {
+			if (laterTrack(winner, losers[node])) {
+				std::swap(winner, losers[node]);
+			}
 		}
 	}
+	if (!group.empty()) {
+		appendGroup();
+	}
 
 	clear_no_deallocate();
 
 	delete m_events[0];
 	m_events.resize(0);
 	m_events.push_back(joinedTrack);
-	sortTracks();
 	if (oldTimeState == TIME_STATE_DELTA) {
 		makeDeltaTicks();
 	}
@@ -1268,31 +1470,30 @@ void MidiFile::makeDeltaTicks(void) {
 	if (getTickState() == TIME_STATE_DELTA) {
 		return;
 	}
-	int i, j;
-	int temp;
 	int length = getNumTracks();
-	int *timedata = new int[length];
-	for (i=0; i<length; i++) {
-		timedata[i] = 0;
-		if (m_events[i]->size() > 0) {
-			timedata[i] = (*m_events[i])[0].tick;
-		} else {
-			continue;
-		}
-		for (j=1; j<(int)m_events[i]->size(); j++) {
-			temp = (*m_events[i])[j].tick;
-			int deltatick = temp - timedata[i];
+	// negative delta ticks are reported after all tracks are processed:
+	std::vector<std::vector<int>> negatives(length);
+	forEachTrack([&](int track) {
+		MidiEventList& eventlist = *m_events[track];
+		int lasttick = eventlist.size() > 0 ? eventlist[0].tick : 0;
+		for (int j=1; j<eventlist.size(); j++) {
+			int temp = eventlist[j].tick;
+			int deltatick = temp - lasttick;
 			if (deltatick < 0) {
-				std::cerr << "Error: negative delta tick value: " << deltatick << std::endl
-				     << "Timestamps must be sorted first"
-				     << " (use MidiFile::sortTracks() before writing)." << std::endl;
+				negatives[track].push_back(deltatick);
 			}
-			(*m_events[i])[j].tick = deltatick;
-			timedata[i] = temp;
+			eventlist[j].tick = deltatick;
+			lasttick = temp;
+		}
+	});
+	for (int i=0; i<length; i++) {
+		for (int deltatick : negatives[i]) {
+			std::cerr << "Error: negative delta tick value: " << deltatick << std::endl
+			     << "Timestamps must be sorted first"
+			     << " (use MidiFile::sortTracks() before writing)." << std::endl;
 		}
 	}
 	m_theTimeState = TIME_STATE_DELTA;
-	delete [] timedata;
 }
 
 //
@@ -1319,23 +1520,15 @@ void MidiFile::makeAbsoluteTicks(void) {
 	if (getTickState() == TIME_STATE_ABSOLUTE) {
 		return;
 	}
-	int i, j;
-	int length = getNumTracks();
-	int* timedata = new int[length];
-	for (i=0; i<length; i++) {
-		timedata[i] = 0;
-		if (m_events[i]->size() > 0) {
-			timedata[i] = (*m_events[i])[0].tick;
-		} else {
-			continue;
+	forEachTrack([&](int track) {
+		MidiEventList& eventlist = *m_events[track];
+		int tick = eventlist.size() > 0 ? eventlist[0].tick : 0;
+		for (int j=1; j<eventlist.size(); j++) {
+			tick += eventlist[j].tick;
+			eventlist[j].tick = tick;
 		}
-		for (j=1; j<(int)m_events[i]->size(); j++) {
-			timedata[i] += (*m_events[i])[j].tick;
-			(*m_events[i])[j].tick = timedata[i];
-		}
-	}
+	});
 	m_theTimeState = TIME_STATE_ABSOLUTE;
-	delete [] timedata;
 }
 
 //
@@ -1442,12 +1635,7 @@ double MidiFile::getFileDurationInQuarters(void) {
 //    of the max time.
 
 double MidiFile::getFileDurationInSeconds(void) {
-	if (m_timemapvalid == 0) {
-		buildTimeMap();
-		if (m_timemapvalid == 0) {
-			return -1.0;    // something went wrong
-		}
-	}
+	updateTimeAnalysis();
 	bool revertToDelta = false;
 	if (isDeltaTicks()) {
 		makeAbsoluteTicks();
@@ -1476,10 +1664,12 @@ double MidiFile::getFileDurationInSeconds(void) {
 //
 // MidiFile::doTimeAnalysis -- Identify the real-time position of
 //    all events by monitoring the tempo in relations to the tick
-//    times in the file.
+//    times in the file.  Call this function after changing the tick
+//    times or tempo messages of existing events directly.
 //
 
 void MidiFile::doTimeAnalysis(void) {
+	m_timemapdirty = 0;
 	buildTimeMap();
 }
 
@@ -1487,41 +1677,36 @@ void MidiFile::doTimeAnalysis(void) {
 
 //////////////////////////////
 //
-// MidiFile::getTimeInSeconds -- return the time in seconds for
-//     the current message.
+// MidiFile::updateTimeAnalysis -- Update the real-time position of
+//    events after tempo changes have been added with the MidiFile
+//    functions.  Only the part of the time map at or after the earliest
+//    added tempo change is recalculated, along with the time in seconds
+//    of the events at or after that tick.  Nothing is done if the time
+//    map is up to date.
 //
 
-double MidiFile::getTimeInSeconds(int aTrack, int anIndex) {
-	return getTimeInSeconds(getEvent(aTrack, anIndex).tick);
+void MidiFile::updateTimeAnalysis(void) {
+	if (m_timemapdirty >= 0) {
+		buildTimeMap();
+	}
 }
 
 
-double MidiFile::getTimeInSeconds(int tickvalue) {
-	if (m_timemapvalid == 0) {
-		buildTimeMap();
-		if (m_timemapvalid == 0) {
-			return -1.0;    // something went wrong
-		}
-	}
 
-	_TickTime key;
-	key.tick    = tickvalue;
-	key.seconds = -1;
+//////////////////////////////
+//
+// MidiFile::getTimeInSeconds -- return the time in seconds for
+//     the current message.
+//
 
-	void* ptr = bsearch(&key, m_timemap.data(), m_timemap.size(),
-			sizeof(_TickTime), ticksearch);
+double MidiFile::getTimeInSeconds(int aTrack, int anIndex) {
+	return getTimeInSeconds(getEvent(aTrack, anIndex).tick);
+}
 
-	if (ptr == NULL) {
-		// The specific tick value was not found, so do a linear
-		// search for the two tick values which occur before and
-		// after the tick value, and do a linear interpolation of
-		// the time in seconds values to figure out the final
-		// time in seconds.
-		// Since the code is not yet written, kill the program at this point:
-		return linearSecondInterpolationAtTick(tickvalue);
-	} else {
-		return ((_TickTime*)ptr)->seconds;
-	}
+
+double MidiFile::getTimeInSeconds(int tickvalue) {
+	updateTimeAnalysis();
+	return linearSecondInterpolationAtTick(tickvalue);
 }
 
 
@@ -1530,34 +1715,13 @@ double MidiFile::getTimeInSeconds(int tickvalue) {
 //
 // MidiFile::getAbsoluteTickTime -- return the tick value represented
 //    by the input time in seconds.  If there is not tick entry at
-//    the given time in seconds, then interpolate between two values.
+//    the given time in seconds, then interpolate between two values
+//    (or extrapolate with the last tempo after the end of the file).
 //
 
 double MidiFile::getAbsoluteTickTime(double starttime) {
-	if (m_timemapvalid == 0) {
-		buildTimeMap();
-		if (m_timemapvalid == 0) {
-			return -1.0;    // something went wrong
-		}
-	}
-
-	_TickTime key;
-	key.tick    = -1;
-	key.seconds = starttime;
-
-	void* ptr = bsearch(&key, m_timemap.data(), m_timemap.size(),
-			sizeof(_TickTime), secondsearch);
-
-	if (ptr == NULL) {
-		// The specific seconds value was not found, so do a linear
-		// search for the two time values which occur before and
-		// after the given time value, and do a linear interpolation of
-		// the time in tick values to figure out the final time in ticks.
-		return linearTickInterpolationAtSecond(starttime);
-	} else {
-		return ((_TickTime*)ptr)->tick;
-	}
-
+	updateTimeAnalysis();
+	return linearTickInterpolationAtSecond(starttime);
 }
 
 
@@ -1575,13 +1739,15 @@ double MidiFile::getAbsoluteTickTime(double starttime) {
 //
 
 int MidiFile::linkNotePairsFIFO(void) {
-	int i;
-	int sum = 0;
-	for (i=0; i<getTrackCount(); i++) {
-		if (m_events[i] == NULL) {
-			continue;
+	std::vector<int> counts(getTrackCount(), 0);
+	forEachTrack([&](int track) {
+		if (m_events[track] != NULL) {
+			counts[track] = m_events[track]->linkNotePairsFIFO();
 		}
-		sum += m_events[i]->linkNotePairsFIFO();
+	});
+	int sum = 0;
+	for (int count : counts) {
+		sum += count;
 	}
 	m_linkedEventsQ = true;
 	return sum;
@@ -1589,13 +1755,15 @@ int MidiFile::linkNotePairsFIFO(void) {
 
 
 int MidiFile::linkNotePairsLIFO(void) {
-	int i;
-	int sum = 0;
-	for (i=0; i<getTrackCount(); i++) {
-		if (m_events[i] == NULL) {
-			continue;
+	std::vector<int> counts(getTrackCount(), 0);
+	forEachTrack([&](int track) {
+		if (m_events[track] != NULL) {
+			counts[track] = m_events[track]->linkNotePairsLIFO();
 		}
-		sum += m_events[i]->linkNotePairsLIFO();
+	});
+	int sum = 0;
+	for (int count : counts) {
+		sum += count;
 	}
 	m_linkedEventsQ = true;
 	return sum;
@@ -1651,12 +1819,12 @@ const char* MidiFile::getFilename(void) const {
 
 MidiEvent* MidiFile::addEvent(int aTrack, int aTick,
 		std::vector<uchar>& midiData) {
-	m_timemapvalid = 0;
 	MidiEvent* me = new MidiEvent;
 	me->tick = aTick;
 	me->track = aTrack;
 	me->setMessage(midiData);
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -1668,13 +1836,16 @@ MidiEvent* MidiFile::addEvent(int aTrack, int aTick,
 //
 
 MidiEvent* MidiFile::addEvent(MidiEvent& mfevent) {
+	MidiEvent* me;
 	if (getTrackState() == TRACK_STATE_JOINED) {
 		m_events[0]->push_back(mfevent);
-		return &m_events[0]->back();
+		me = &m_events[0]->back();
 	} else {
 		m_events.at(mfevent.track)->push_back(mfevent);
-		return &m_events.at(mfevent.track)->back();
+		me = &m_events.at(mfevent.track)->back();
 	}
+	updateEventSeconds(*me);
+	return me;
 }
 
 //
@@ -1682,15 +1853,17 @@ MidiEvent* MidiFile::addEvent(MidiEvent& mfevent) {
 //
 
 MidiEvent* MidiFile::addEvent(int aTrack, MidiEvent& mfevent) {
+	MidiEvent* me;
 	if (getTrackState() == TRACK_STATE_JOINED) {
 		m_events[0]->push_back(mfevent);
-      m_events[0]->back().track = aTrack;
-		return &m_events[0]->back();
+		me = &m_events[0]->back();
 	} else {
 		m_events.at(aTrack)->push_back(mfevent);
-		m_events.at(aTrack)->back().track = aTrack;
-		return &m_events.at(aTrack)->back();
+		me = &m_events.at(aTrack)->back();
 	}
+	me->track = aTrack;
+	updateEventSeconds(*me);
+	return me;
 }
 
 
@@ -1702,7 +1875,6 @@ MidiEvent* MidiFile::addEvent(int aTrack, MidiEvent& mfevent) {
 
 MidiEvent* MidiFile::addMetaEvent(int aTrack, int aTick, int aType,
 		std::vector<uchar>& metaData) {
-	m_timemapvalid = 0;
 	int i;
 	int length = (int)metaData.size();
 	std::vector<uchar> fulldata;
@@ -1747,6 +1919,7 @@ MidiEvent* MidiFile::addText(int aTrack, int aTick, const std::string& text) {
 	me->makeText(text);
 	me->tick = aTick;
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -1762,6 +1935,7 @@ MidiEvent* MidiFile::addCopyright(int aTrack, int aTick, const std::string& text
 	me->makeCopyright(text);
 	me->tick = aTick;
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -1777,6 +1951,7 @@ MidiEvent* MidiFile::addTrackName(int aTrack, int aTick, const std::string& name
 	me->makeTrackName(name);
 	me->tick = aTick;
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -1793,6 +1968,7 @@ MidiEvent* MidiFile::addInstrumentName(int aTrack, int aTick,
 	me->makeInstrumentName(name);
 	me->tick = aTick;
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -1808,6 +1984,7 @@ MidiEvent* MidiFile::addLyric(int aTrack, int aTick, const std::string& text) {
 	me->makeLyric(text);
 	me->tick = aTick;
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -1823,6 +2000,7 @@ MidiEvent* MidiFile::addMarker(int aTrack, int aTick, const std::string& text) {
 	me->makeMarker(text);
 	me->tick = aTick;
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -1838,6 +2016,7 @@ MidiEvent* MidiFile::addCue(int aTrack, int aTick, const std::string& text) {
 	me->makeCue(text);
 	me->tick = aTick;
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -1853,6 +2032,7 @@ MidiEvent* MidiFile::addTempo(int aTrack, int aTick, double aTempo) {
 	me->makeTempo(aTempo);
 	me->tick = aTick;
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -1877,6 +2057,7 @@ MidiEvent* MidiFile::addKeySignature (int aTrack, int aTick, int fifths, bool mo
     me->makeKeySignature(fifths, mode);
     me->tick = aTick;
     m_events[aTrack]->push_back_no_copy(me);
+    updateEventSeconds(*me);
     return me;
 }
 
@@ -1911,6 +2092,7 @@ MidiEvent* MidiFile::addTimeSignature(int aTrack, int aTick, int top, int bottom
 	me->makeTimeSignature(top, bottom, clocksPerClick, num32ndsPerQuarter);
 	me->tick = aTick;
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -2003,6 +2185,7 @@ MidiEvent* MidiFile::addNoteOn(int aTrack, int aTick, int aChannel, int key, int
 	me->makeNoteOn(aChannel, key, vel);
 	me->tick = aTick;
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -2019,6 +2202,7 @@ MidiEvent* MidiFile::addNoteOff(int aTrack, int aTick, int aChannel, int key,
 	me->makeNoteOff(aChannel, key, vel);
 	me->tick = aTick;
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -2035,6 +2219,7 @@ MidiEvent* MidiFile::addNoteOff(int aTrack, int aTick, int aChannel, int key) {
 	me->makeNoteOff(aChannel, key);
 	me->tick = aTick;
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -2052,6 +2237,7 @@ MidiEvent* MidiFile::addController(int aTrack, int aTick, int aChannel,
 	me->makeController(aChannel, num, value);
 	me->tick = aTick;
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -2069,6 +2255,7 @@ MidiEvent* MidiFile::addPatchChange(int aTrack, int aTick, int aChannel,
 	me->makePatchChange(aChannel, patchnum);
 	me->tick = aTick;
 	m_events[aTrack]->push_back_no_copy(me);
+	updateEventSeconds(*me);
 	return me;
 }
 
@@ -2098,7 +2285,6 @@ MidiEvent* MidiFile::addTimbre(int aTrack, int aTick, int aChannel, int patchnum
 //
 
 MidiEvent* MidiFile::addPitchBend(int aTrack, int aTick, int aChannel, double amount) {
-	m_timemapvalid = 0;
 	amount += 1.0;
 	int value = int(amount * 8192 + 0.5);
 
@@ -2294,6 +2480,19 @@ void MidiFile::deleteTrack(int aTrack) {
 	if (length == 1) {
 		return;
 	}
+	// The track may not be sorted, so find the earliest tempo change:
+	MidiEventList& eventlist = *m_events[aTrack];
+	int tick = 0;
+	int tempotick = -1;
+	for (int i=0; i<eventlist.size(); i++) {
+		tick = isDeltaTicks() ? tick + eventlist[i].tick : eventlist[i].tick;
+		if (eventlist[i].isTempo() && ((tempotick < 0) || (tick < tempotick))) {
+			tempotick = tick;
+		}
+	}
+	if (tempotick >= 0) {
+		markTimeMapDirty(tempotick);
+	}
 	delete m_events[aTrack];
 	for (int i=aTrack; i<length-1; i++) {
 		m_events[i] = m_events[i+1];
@@ -2319,7 +2518,8 @@ void MidiFile::clear(void) {
 	}
 	m_events.resize(1);
 	m_events[0] = new MidiEventList;
-	m_timemapvalid=0;
+	m_arena.clear();
+	m_timemapdirty = 0;
 	m_timemap.clear();
 	m_theTrackState = TRACK_STATE_SPLIT;
 	m_theTimeState = TIME_STATE_ABSOLUTE;
@@ -2450,6 +2650,7 @@ void MidiFile::mergeTracks(int aTrack1, int aTrack2) {
 
 void MidiFile::setTicksPerQuarterNote(int ticks) {
 	m_ticksPerQuarterNote = ticks;
+	m_timemapdirty = 0;
 }
 
 //
@@ -2478,6 +2679,7 @@ void MidiFile::setTPQ(int ticks) {
 
 void MidiFile::setMillisecondTicks(void) {
 	m_ticksPerQuarterNote = 0xE728;
+	m_timemapdirty = 0;
 }
 
 
@@ -2517,9 +2719,9 @@ void MidiFile::sortTrackNoteOffsBeforeOns(int track) {
 
 void MidiFile::sortTracksNoteOnsBeforeOffs(void) {
 	if (m_theTimeState == TIME_STATE_ABSOLUTE) {
-		for (int i=0; i<getTrackCount(); i++) {
-			m_events.at(i)->sortNoteOnsBeforeOffs();
-		}
+		forEachTrack([&](int track) {
+			m_events[track]->sortNoteOnsBeforeOffs();
+		});
 	} else {
 		std::cerr << "Warning: Sorting only allowed in absolute tick mode.";
 	}
@@ -2527,9 +2729,9 @@ void MidiFile::sortTracksNoteOnsBeforeOffs(void) {
 
 void MidiFile::sortTracksNoteOffsBeforeOns(void) {
 	if (m_theTimeState == TIME_STATE_ABSOLUTE) {
-		for (int i=0; i<getTrackCount(); i++) {
-			m_events.at(i)->sortNoteOffsBeforeOns();
-		}
+		forEachTrack([&](int track) {
+			m_events[track]->sortNoteOffsBeforeOns();
+		});
 	} else {
 		std::cerr << "Warning: Sorting only allowed in absolute tick mode.";
 	}
@@ -2568,13 +2770,86 @@ int MidiFile::getTrackCountAsType1(void) {
 //
 
 void MidiFile::clearLinks(void) {
+	forEachTrack([&](int track) {
+		if (m_events[track] != NULL) {
+			m_events[track]->clearLinks();
+		}
+	});
+	m_linkedEventsQ = false;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::getFingerprint -- Return a 64-bit hash of the musical content
+//    of the file, for finding copies of the same music which are stored
+//    differently.  The hash does not depend on the order or number of
+//    the tracks, the order of events within a tick, running status,
+//    end-of-track messages, note-off velocities, note-on/velocity-0
+//    versus note-off messages, or note-offs for notes which are not
+//    sounding.  The ticks-per-quarter-note value is included, so files
+//    with different tick resolutions give different hashes.
+//
+
+uint64_t MidiFile::getFingerprint(void) const {
+	// Each event is hashed separately with its absolute tick, and the
+	// event hashes are added together so that the order of events does
+	// not matter.
+	uint64_t sum = 0;
+	uint64_t count = 0;
+	int noteons[16 * 128];
+	bool deltaQ = isDeltaTicks();
 	for (int i=0; i<getTrackCount(); i++) {
 		if (m_events[i] == NULL) {
 			continue;
 		}
-		m_events[i]->clearLinks();
+		const MidiEventList& eventlist = *m_events[i];
+		std::fill(noteons, noteons + 16 * 128, 0);
+		int tick = 0;
+		for (int j=0; j<eventlist.size(); j++) {
+			const MidiEvent& event = eventlist[j];
+			if (deltaQ) {
+				tick += event.tick;
+			} else {
+				tick = event.tick;
+			}
+			uint64_t value;
+			if (event.isNoteOn()) {
+				int channel = event.getChannel();
+				int key = event.getKeyNumber();
+				noteons[channel * 128 + key]++;
+				value = (3ULL << 24) | ((0x90ULL | channel) << 16) | (key << 8) |
+						event.getVelocity();
+			} else if (event.isNoteOff()) {
+				int channel = event.getChannel();
+				int key = event.getKeyNumber();
+				if (noteons[channel * 128 + key] == 0) {
+					// redundant note-off
+					continue;
+				}
+				noteons[channel * 128 + key]--;
+				value = (3ULL << 24) | ((0x80ULL | channel) << 16) | (key << 8);
+			} else if (event.isEndOfTrack()) {
+				continue;
+			} else if (event.size() <= 3) {
+				value = (uint64_t)event.size() << 24;
+				for (int k=0; k<(int)event.size(); k++) {
+					value |= (uint64_t)event[k] << (16 - 8 * k);
+				}
+			} else {
+				// FNV-1a hash of longer messages:
+				value = 14695981039346656037ULL;
+				for (uchar byte : event) {
+					value = (value ^ byte) * 1099511628211ULL;
+				}
+			}
+			sum += mixFingerprint(mixFingerprint(value) ^ (uint32_t)tick);
+			count++;
+		}
 	}
-	m_linkedEventsQ = false;
+	return mixFingerprint(sum ^ mixFingerprint((count << 16) ^
+			(uint64_t)(ushort)m_ticksPerQuarterNote));
 }
 
 
@@ -2586,68 +2861,49 @@ void MidiFile::clearLinks(void) {
 
 //////////////////////////////
 //
-// MidiFile::linearTickInterpolationAtSecond -- return the tick value at the
-//    given input time.
+// MidiFile::mixFingerprint -- Scramble the bits of a value for
+//    getFingerprint() (the splitmix64 finalizer).
 //
 
-double MidiFile::linearTickInterpolationAtSecond(double seconds) {
-	if (m_timemapvalid == 0) {
-		buildTimeMap();
-		if (m_timemapvalid == 0) {
-			return -1.0;    // something went wrong
-		}
-	}
+uint64_t MidiFile::mixFingerprint(uint64_t value) {
+	value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+	return value ^ (value >> 31);
+}
 
-	int i;
-	double lasttime = m_timemap[m_timemap.size()-1].seconds;
-	// give an error value of -1 if time is out of range of data.
+
+
+//////////////////////////////
+//
+// MidiFile::linearTickInterpolationAtSecond -- return the tick value at the
+//    given input time.  The tempo segment containing the time is found
+//    with a binary search, and the tick is interpolated within it.
+//    Times after the last tempo change use the last tempo.  Returns -1.0
+//    for negative times.  The time map must be up to date.
+//
+
+double MidiFile::linearTickInterpolationAtSecond(double seconds) const {
 	if (seconds < 0.0) {
 		return -1.0;
 	}
-	if (seconds > m_timemap[m_timemap.size()-1].seconds) {
-		return -1.0;
-	}
 
-	// Guess which side of the list is closest to target:
-	// Could do a more efficient algorithm since time values are sorted,
-	// but good enough for now...
-	int startindex = -1;
-	if (seconds < lasttime / 2) {
-		for (i=0; i<(int)m_timemap.size(); i++) {
-			if (m_timemap[i].seconds > seconds) {
-				startindex = i-1;
-				break;
-			} else if (m_timemap[i].seconds == seconds) {
-				startindex = i;
-				break;
-			}
-		}
-	} else {
-		for (i=(int)m_timemap.size()-1; i>0; i--) {
-			if (m_timemap[i].seconds < seconds) {
-				startindex = i+1;
-				break;
-			} else if (m_timemap[i].seconds == seconds) {
-				startindex = i;
-				break;
-			}
-		}
+	// find the last segment starting at or before the given time:
+	auto it = std::upper_bound(m_timemap.begin() + 1, m_timemap.end(), seconds,
+			[](double value, const _TempoSegment& segment) {
+				return value < segment.seconds;
+			});
+	const _TempoSegment& segment = *(it - 1);
+	if (segment.secondsPerTick <= 0.0) {
+		return segment.tick;
 	}
+	double output = segment.tick + (seconds - segment.seconds) / segment.secondsPerTick;
 
-	if (startindex < 0) {
-		return -1.0;
+	// Remove rounding errors for times which fall on a tick.
+	double rounded = std::round(output);
+	if (std::fabs(output - rounded) < 1.0e-6) {
+		output = rounded;
 	}
-	if (startindex >= (int)m_timemap.size()-1) {
-		return -1.0;
-	}
-
-	double x1 = m_timemap[startindex].seconds;
-	double x2 = m_timemap[startindex+1].seconds;
-	double y1 = m_timemap[startindex].tick;
-	double y2 = m_timemap[startindex+1].tick;
-	double xi = seconds;
-
-	return (xi-x1) * ((y2-y1)/(x2-x1)) + y1;
+	return output;
 }
 
 
@@ -2656,187 +2912,299 @@ double MidiFile::linearTickInterpolationAtSecond(double seconds) {
 //
 // MidiFile::linearSecondInterpolationAtTick -- return the time in seconds
 //    value at the given input tick time. (Ticks input could be made double).
+//    The tempo segment containing the tick is found with a binary search.
+//    Returns -1.0 for negative ticks.  The time map must be up to date.
 //
 
-double MidiFile::linearSecondInterpolationAtTick(int ticktime) {
-	if (m_timemapvalid == 0) {
-		buildTimeMap();
-		if (m_timemapvalid == 0) {
-			return -1.0;    // something went wrong
-		}
+double MidiFile::linearSecondInterpolationAtTick(int ticktime) const {
+	if (ticktime < 0) {
+		return -1.0;
 	}
 
-	int i;
-	double lasttick = m_timemap[m_timemap.size()-1].tick;
-	// give an error value of -1 if time is out of range of data.
-	if (ticktime < 0.0) {
-		return -1;
-	}
-	if (ticktime > m_timemap.back().tick) {
-		return -1;  // don't try to extrapolate
-	}
+	// find the last segment starting at or before the given tick:
+	auto it = std::upper_bound(m_timemap.begin() + 1, m_timemap.end(), ticktime,
+			[](int value, const _TempoSegment& segment) {
+				return value < segment.tick;
+			});
+	const _TempoSegment& segment = *(it - 1);
+	return segment.seconds + (ticktime - segment.tick) * segment.secondsPerTick;
+}
 
-	// Guess which side of the list is closest to target:
-	// Could do a more efficient algorithm since time values are sorted,
-	// but good enough for now...
-	int startindex = -1;
-	if (ticktime < lasttick / 2) {
-		for (i=0; i<(int)m_timemap.size(); i++) {
-			if (m_timemap[i].tick > ticktime) {
-				startindex = i-1;
-				break;
-			} else if (m_timemap[i].tick == ticktime) {
-				startindex = i;
-				break;
+
+
+//////////////////////////////
+//
+// MidiFile::buildTimeMap -- build a table of the tempo segments in the
+//      MIDI file: the starting tick, time in seconds at that tick, and
+//      seconds per tick for each tempo change.  If no tempo messages
+//      are given (or until they are given, then the tempo is set to 120
+//      beats per minute).  When there are several tempo changes at the
+//      same tick, the last one (in track order) is used.  The time in
+//      seconds of the events is then calculated from the table one track
+//      at a time.  Only the tempo segments and event times at or after
+//      m_timemapdirty are recalculated (the whole map when it is 0).
+//      The events can be in either tick or track state, which will not be
+//      changed.  If SMPTE time code is used, then ticks are
+//      actually time values.  So don't build a time map for SMPTE ticks, and
+//      just calculate the time in seconds from the tick value (1000
+//      ticks per second SMPTE is the only mode tested (25 frames per
+//      second and 40 subframes per frame).
+//
+
+void MidiFile::buildTimeMap(void) {
+	int tpq = getTicksPerQuarterNote();
+	double defaultTempo = 120.0;
+	bool deltaQ = isDeltaTicks();
+	int starttick = m_timemap.empty() ? 0 : m_timemapdirty;
+
+	// collect the tempo changes to recalculate (in absolute ticks):
+	std::vector<std::pair<int, double>> tempos;
+	for (int i=0; i<getNumTracks(); i++) {
+		MidiEventList& eventlist = *m_events[i];
+		int tick = 0;
+		for (int j=0; j<eventlist.size(); j++) {
+			tick = deltaQ ? tick + eventlist[j].tick : eventlist[j].tick;
+			if ((tick >= starttick) && eventlist[j].isTempo()) {
+				tempos.emplace_back(tick, eventlist[j].getTempoSPT(tpq));
 			}
 		}
+	}
+	std::stable_sort(tempos.begin(), tempos.end(),
+		[](const std::pair<int, double>& a, const std::pair<int, double>& b) {
+			return a.first < b.first;
+		});
+
+	// convert the tempo changes into segments (keeping the segments
+	// before the starting tick):
+	_TempoSegment segment;
+	if (starttick <= 0) {
+		segment.tick           = 0;
+		segment.seconds        = 0.0;
+		segment.secondsPerTick = 60.0 / (defaultTempo * tpq);
+		m_timemap.clear();
+		m_timemap.push_back(segment);
 	} else {
-		for (i=(int)m_timemap.size()-1; i>0; i--) {
-			if (m_timemap[i].tick < ticktime) {
-				startindex = i;
-				break;
-			} else if (m_timemap[i].tick == ticktime) {
-				startindex = i;
-				break;
-			}
+		auto it = std::lower_bound(m_timemap.begin() + 1, m_timemap.end(), starttick,
+				[](const _TempoSegment& entry, int value) {
+					return entry.tick < value;
+				});
+		m_timemap.erase(it, m_timemap.end());
+	}
+	for (auto& tempo : tempos) {
+		_TempoSegment& last = m_timemap.back();
+		if (tempo.first <= last.tick) {
+			last.secondsPerTick = tempo.second;
+			continue;
 		}
+		if (tempo.second == last.secondsPerTick) {
+			continue;
+		}
+		segment.seconds        = last.seconds + (tempo.first - last.tick) *
+				last.secondsPerTick;
+		segment.tick           = tempo.first;
+		segment.secondsPerTick = tempo.second;
+		m_timemap.push_back(segment);
 	}
+	m_timemapdirty = -1;
 
-	if (startindex < 0) {
-		return -1;
-	}
-	if (startindex >= (int)m_timemap.size()-1) {
-		return -1;
-	}
+	// calculate the time in seconds for each event:
+	forEachTrack([&](int track) {
+		updateTrackSeconds(*m_events[track], deltaQ, starttick);
+	});
+}
 
-	if (m_timemap[startindex].tick == ticktime) {
-		return m_timemap[startindex].seconds;
-	}
 
-	double x1 = m_timemap[startindex].tick;
-	double x2 = m_timemap[startindex+1].tick;
-	double y1 = m_timemap[startindex].seconds;
-	double y2 = m_timemap[startindex+1].seconds;
-	double xi = ticktime;
 
-	return (xi-x1) * ((y2-y1)/(x2-x1)) + y1;
+//////////////////////////////
+//
+// MidiFile::updateTrackSeconds -- Calculate the time in seconds of the
+//      events in a track from the tempo segment table.  Since the events
+//      of a track are normally sorted by tick, the tempo segments are
+//      merged with the event ticks in one pass (with a binary search for
+//      any event earlier than the previous one).  Events before starttick
+//      are not changed.  Only the given track is modified, so tracks can
+//      be processed independently.
+//
+
+void MidiFile::updateTrackSeconds(MidiEventList& eventlist, bool deltaQ,
+		int starttick) const {
+	const std::vector<_TempoSegment>& segments = m_timemap;
+	int count = (int)segments.size();
+	int s = 0;
+	int tick = 0;
+	for (int j=0; j<eventlist.size(); j++) {
+		tick = deltaQ ? tick + eventlist[j].tick : eventlist[j].tick;
+		if (tick < starttick) {
+			continue;
+		}
+		if (tick < segments[s].tick) {
+			auto it = std::upper_bound(segments.begin() + 1, segments.end(), tick,
+					[](int value, const _TempoSegment& segment) {
+						return value < segment.tick;
+					});
+			s = (int)(it - segments.begin()) - 1;
+		}
+		while ((s + 1 < count) && (segments[s+1].tick <= tick)) {
+			s++;
+		}
+		const _TempoSegment& segment = segments[s];
+		eventlist[j].seconds = segment.seconds + (tick - segment.tick) *
+				segment.secondsPerTick;
+	}
 }
 
 
 
 //////////////////////////////
 //
-// MidiFile::buildTimeMap -- build an index of the absolute tick values
-//      found in a MIDI file, and their corresponding time values in
-//      seconds, taking into consideration tempo change messages.  If no
-//      tempo messages are given (or until they are given, then the
-//      tempo is set to 120 beats per minute).  If SMPTE time code is
-//      used, then ticks are actually time values.  So don't build
-//      a time map for SMPTE ticks, and just calculate the time in
-//      seconds from the tick value (1000 ticks per second SMPTE
-//      is the only mode tested (25 frames per second and 40 subframes
-//      per frame).
+// MidiFile::updateEventSeconds -- Calculate the time in seconds of an
+//      event which was added to the file.  Adding a tempo change marks the
+//      time map as out of date from the tick of the tempo change.  Other
+//      events are given their time in seconds from the time map if it is
+//      up to date at their tick (otherwise it will be done when the time
+//      map is updated).
 //
 
-void MidiFile::buildTimeMap(void) {
+void MidiFile::updateEventSeconds(MidiEvent& event) {
+	if (isDeltaTicks()) {
+		// The absolute tick of the event is not known.
+		markTimeMapDirty(0);
+		return;
+	}
+	if (event.isTempo()) {
+		markTimeMapDirty(event.tick);
+		return;
+	}
+	if (m_timemap.empty() || (event.tick < 0)) {
+		return;
+	}
+	if ((m_timemapdirty < 0) || (event.tick < m_timemapdirty)) {
+		event.seconds = linearSecondInterpolationAtTick(event.tick);
+	}
+}
 
-	// convert the MIDI file to absolute time representation
-	// in single track mode (and undo if the MIDI file was not
-	// in that state when this function was called.
-	//
-	int trackstate = getTrackState();
-	int timestate  = getTickState();
 
-	makeAbsoluteTicks();
-	joinTracks();
 
-	int allocsize = getNumEvents(0);
-	m_timemap.reserve(allocsize+10);
-	m_timemap.clear();
+//////////////////////////////
+//
+// MidiFile::markTimeMapDirty -- Mark the time map and event times in
+//      seconds as out of date from the given tick.
+//
 
-	_TickTime value;
+void MidiFile::markTimeMapDirty(int tick) {
+	if (tick < 0) {
+		tick = 0;
+	}
+	if ((m_timemapdirty < 0) || (tick < m_timemapdirty)) {
+		m_timemapdirty = tick;
+	}
+}
 
-	int lasttick = 0;
-	int tickinit = 0;
 
-	int i;
-	int tpq = getTicksPerQuarterNote();
-	double defaultTempo = 120.0;
-	double secondsPerTick = 60.0 / (defaultTempo * tpq);
 
-	double lastsec = 0.0;
-	double cursec = 0.0;
+//////////////////////////////
+//
+// MidiFile::readError -- Store a description of a read error, and
+//    print it if error printing is turned on.
+//
+
+void MidiFile::readError(const MidiFileError& error) {
+	m_error = error;
+	if (m_printErrorsQ) {
+		std::cerr << error.getMessage() << std::endl;
+	}
+}
 
-	for (i=0; i<getNumEvents(0); i++) {
-		int curtick = getEvent(0, i).tick;
-		getEvent(0, i).seconds = cursec;
-		if ((curtick > lasttick) || !tickinit) {
-			tickinit = 1;
 
-			// calculate the current time in seconds:
-			cursec = lastsec + (curtick - lasttick) * secondsPerTick;
-			getEvent(0, i).seconds = cursec;
 
-			// store the new tick to second mapping
-			value.tick = curtick;
-			value.seconds = cursec;
-			m_timemap.push_back(value);
-			lasttick   = curtick;
-			lastsec    = cursec;
+//////////////////////////////
+//
+// MidiFile::readTrackData -- Read the MIDI events of a track chunk
+//    (after the MTrk header) into the given event list, allocating the
+//    events from the given arena.  The timestamps are converted from
+//    delta ticks to absolute ticks.  The pointer is left after the
+//    end-of-track message.  Returns false if the track data is malformed
+//    or truncated, with a description of the problem in the error
+//    object, and the pointer at the problem.  Does not change the state
+//    of the object (other than the event list), so tracks can be read
+//    in parallel.
+//
+
+bool MidiFile::readTrackData(const uchar*& ptr, const uchar* end,
+		MidiEventList& eventlist, MidiEventArena& arena, int track,
+		MidiFileError& error) {
+
+	// Read MIDI events in the track, which are pairs of VLV values
+	// and then the bytes for the MIDI message.  Running status messages
+	// will be filled in with their implicit command byte.
+	// The timestamps are converted from delta ticks to absolute ticks,
+	// with the absticks variable accumulating the VLV tick values.
+	uchar runningCommand = 0;
+	ulong longdata;
+	int absticks = 0;
+	while (ptr < end) {
+		if (!readVLValue(ptr, end, longdata, error)) {
+			return false;
 		}
-
-		// update the tempo if needed:
-		if (getEvent(0,i).isTempo()) {
-			secondsPerTick = getEvent(0,i).getTempoSPT(getTicksPerQuarterNote());
+		absticks += longdata;
+		MidiEvent* event = arena.newEvent();
+		if (!extractMidiData(ptr, end, *event, runningCommand, error)) {
+			MidiEventArena::deleteEvent(event);
+			return false;
+		}
+		event->tick = absticks;
+		event->track = track;
+		eventlist.push_back_no_copy(event);
+
+		if ((event->size() >= 2) && ((*event)[0] == 0xff) && ((*event)[1] == 0x2f)) {
+			// end-of-track message (which is always required, and will added
+			// automatically when a MIDI is written).
+			return true;
 		}
 	}
 
-	// reset the states of the tracks or time values if necessary here:
-	if (timestate == TIME_STATE_DELTA) {
-		deltaTicks();
-	}
-	if (trackstate == TRACK_STATE_SPLIT) {
-		splitTracks();
-	}
-
-	m_timemapvalid = 1;
-
+	error.setError(MidiFileError::ERROR_TRUNCATED,
+			"Error: unexpected end of file.");
+	return false;
 }
 
 
 
 //////////////////////////////
 //
-// MidiFile::extractMidiData -- Extract MIDI data from input
-//    stream.  Return value is 0 if failure; otherwise, returns 1.
+// MidiFile::extractMidiData -- Extract MIDI data from a memory buffer,
+//    advancing the pointer past the message.  Return value is 0 if
+//    failure (with a description in the error object, and the pointer
+//    at the problem byte); otherwise, returns 1.
 //
 
-int MidiFile::extractMidiData(std::istream& input, std::vector<uchar>& array,
-	uchar& runningCommand) {
+int MidiFile::extractMidiData(const uchar*& ptr, const uchar* end,
+		std::vector<uchar>& array, uchar& runningCommand, MidiFileError& error) {
 
-	int character;
 	uchar byte;
-	array.clear();
 	int runningQ;
 
-	character = input.get();
-	if (character == EOF) {
-		std::cerr << "Error: unexpected end of file." << std::endl;
+	if (ptr >= end) {
+		error.setError(MidiFileError::ERROR_TRUNCATED,
+				"Error: unexpected end of file.");
 		return 0;
-	} else {
-		byte = (uchar)character;
 	}
+	byte = *ptr++;
 
 	if (byte < 0x80) {
 		runningQ = 1;
 		if (runningCommand == 0) {
-			std::cerr << "Error: running command with no previous command" << std::endl;
+			ptr--;
+			error.setError(MidiFileError::ERROR_RUNNING_STATUS,
+					"Error: running command with no previous command");
 			return 0;
 		}
 		if (runningCommand >= 0xf0) {
-			std::cerr << "Error: running status not permitted with meta and sysex"
-			     << " event." << std::endl;
-			std::cerr << "Byte is 0x" << std::hex << (int)byte << std::dec << std::endl;
+			std::stringstream message;
+			message << "Error: running status not permitted with meta and sysex"
+			        << " event.\nByte is 0x" << std::hex << (int)byte;
+			ptr--;
+			error.setError(MidiFileError::ERROR_RUNNING_STATUS, message.str());
 			return 0;
 		}
 	} else {
@@ -2844,98 +3212,66 @@ int MidiFile::extractMidiData(std::istream& input, std::vector<uchar>& array,
 		runningQ = 0;
 	}
 
-	array.push_back(runningCommand);
-	if (runningQ) {
-		array.push_back(byte);
-	}
-
 	switch (runningCommand & 0xf0) {
 		case 0x80:        // note off (2 more bytes)
 		case 0x90:        // note on (2 more bytes)
 		case 0xA0:        // aftertouch (2 more bytes)
 		case 0xB0:        // cont. controller (2 more bytes)
 		case 0xE0:        // pitch wheel (2 more bytes)
-			byte = readByte(input);
-			if (!status()) { return m_rwstatus; }
-			if (byte > 0x7f) {
-				std::cerr << "MIDI data byte too large: " << (int)byte << std::endl;
-				m_rwstatus = false; return m_rwstatus;
-			}
-			array.push_back(byte);
-			if (!runningQ) {
-				byte = readByte(input);
-				if (!status()) { return m_rwstatus; }
-				if (byte > 0x7f) {
-					std::cerr << "MIDI data byte too large: " << (int)byte << std::endl;
-					m_rwstatus = false; return m_rwstatus;
-				}
-				array.push_back(byte);
-			}
-			break;
 		case 0xC0:        // patch change (1 more byte)
 		case 0xD0:        // channel pressure (1 more byte)
-			if (!runningQ) {
-				byte = readByte(input);
-				if (!status()) { return m_rwstatus; }
+			{
+			uchar message[3] = {runningCommand, 0, 0};
+			int length = 1;
+			if (runningQ) {
+				message[length++] = byte;
+			}
+			int count = 3;
+			if (((runningCommand & 0xf0) == 0xC0) || ((runningCommand & 0xf0) == 0xD0)) {
+				count = 2;
+			}
+			while (length < count) {
+				if (ptr >= end) {
+					error.setError(MidiFileError::ERROR_TRUNCATED,
+							"Error: unexpected end of file.");
+					return 0;
+				}
+				byte = *ptr++;
 				if (byte > 0x7f) {
-					std::cerr << "MIDI data byte too large: " << (int)byte << std::endl;
-					m_rwstatus = false; return m_rwstatus;
+					ptr--;
+					error.setError(MidiFileError::ERROR_DATA_BYTE,
+							"MIDI data byte too large: " + std::to_string((int)byte));
+					return 0;
 				}
-				array.push_back(byte);
+				message[length++] = byte;
+			}
+			array.assign(message, message + length);
 			}
 			break;
 		case 0xF0:
 			switch (runningCommand) {
 				case 0xff:                 // meta event
 					{
-					if (!runningQ) {
-						byte = readByte(input); // meta type
-						if (!status()) { return m_rwstatus; }
-						array.push_back(byte);
+					// The meta type, VLV length and data are stored as
+					// read from the file, so copy them in one step.
+					const uchar* start = ptr - 1;
+					if (ptr >= end) {
+						error.setError(MidiFileError::ERROR_TRUNCATED,
+								"Error: unexpected end of file.");
+						return 0;
 					}
-					ulong length = 0;
-					uchar byte1 = 0;
-					uchar byte2 = 0;
-					uchar byte3 = 0;
-					uchar byte4 = 0;
-					byte1 = readByte(input);
-					if (!status()) { return m_rwstatus; }
-					array.push_back(byte1);
-					if (byte1 >= 0x80) {
-						byte2 = readByte(input);
-						if (!status()) { return m_rwstatus; }
-						array.push_back(byte2);
-						if (byte2 > 0x80) {
-							byte3 = readByte(input);
-							if (!status()) { return m_rwstatus; }
-							array.push_back(byte3);
-							if (byte3 >= 0x80) {
-								byte4 = readByte(input);
-								if (!status()) { return m_rwstatus; }
-								array.push_back(byte4);
-								if (byte4 >= 0x80) {
-									std::cerr << "Error: cannot handle large VLVs" << std::endl;
-									m_rwstatus = false; return m_rwstatus;
-								} else {
-									length = unpackVLV(byte1, byte2, byte3, byte4);
-									if (!m_rwstatus) { return m_rwstatus; }
-								}
-							} else {
-								length = unpackVLV(byte1, byte2, byte3);
-								if (!m_rwstatus) { return m_rwstatus; }
-							}
-						} else {
-							length = unpackVLV(byte1, byte2);
-							if (!m_rwstatus) { return m_rwstatus; }
-						}
-					} else {
-						length = byte1;
+					ptr++;              // meta type
+					ulong length;
+					if (!readVLValue(ptr, end, length, error)) {
+						return 0;
 					}
-					for (int j=0; j<(int)length; j++) {
-						byte = readByte(input); // meta type
-						if (!status()) { return m_rwstatus; }
-						array.push_back(byte);
+					if (length > (ulong)(end - ptr)) {
+						error.setError(MidiFileError::ERROR_TRUNCATED,
+								"Error: unexpected end of file.");
+						return 0;
 					}
+					ptr += length;
+					array.assign(start, ptr);
 					}
 					break;
 
@@ -2953,22 +3289,32 @@ int MidiFile::extractMidiData(std::istream& input, std::vector<uchar>& array,
 				             // that this is a raw byte message.
 				case 0xf0:   // System Exclusive message
 					{         // (complete, or start of message).
-					int length = (int)readVLValue(input);
-					for (int i=0; i<length; i++) {
-						byte = readByte(input);
-						if (!status()) { return m_rwstatus; }
-						array.push_back(byte);
+					ulong length;
+					if (!readVLValue(ptr, end, length, error)) {
+						return 0;
+					}
+					if (length > (ulong)(end - ptr)) {
+						error.setError(MidiFileError::ERROR_TRUNCATED,
+								"Error: unexpected end of file.");
+						return 0;
 					}
+					array.reserve(length + 1);
+					array.assign(1, runningCommand);
+					array.insert(array.end(), ptr, ptr + length);
+					ptr += length;
 					}
 					break;
 
 				// other "F" MIDI commands are not expected, but can be
 				// handled here if they exist.
+				default:
+					array.assign(1, runningCommand);
 			}
 			break;
 		default:
-			std::cout << "Error reading midifile" << std::endl;
-			std::cout << "Command byte was " << (int)runningCommand << std::endl;
+			error.setError(MidiFileError::ERROR_COMMAND_BYTE,
+					"Error reading midifile\nCommand byte was "
+					+ std::to_string((int)runningCommand));
 			return 0;
 	}
 	return 1;
@@ -2978,59 +3324,200 @@ int MidiFile::extractMidiData(std::istream& input, std::vector<uchar>& array,
 
 //////////////////////////////
 //
-// MidiFile::readVLValue -- The VLV value is expected to be unpacked into
-//   a 4-byte integer no greater than 0x0fffFFFF, so a VLV value up to
-//   4-bytes in size (FF FF FF 7F) will only be considered.  Longer
-//   VLV values are not allowed in standard MIDI files, so the extract
-//   delta time would be truncated and the extra byte(s) will be parsed
-//   incorrectly as a MIDI command.
-//
+// MidiFile::readVLValue -- Read a VLV value from a memory buffer,
+//   advancing the pointer past it.  The VLV value is expected to be
+//   unpacked into a 4-byte integer no greater than 0x0fffFFFF, so a VLV
+//   value up to 4-bytes in size (FF FF FF 7F) will only be considered.
+//   A fifth byte is tolerated for compatibility with files that
+//   were accepted by earlier versions of the parser.  Returns false
+//   if the value is too large or truncated (with a description in the
+//   error object).
+//
+
+bool MidiFile::readVLValue(const uchar*& ptr, const uchar* end, ulong& value,
+		MidiFileError& error) {
+	value = 0;
+	for (int i=0; i<5; i++) {
+		if (ptr >= end) {
+			error.setError(MidiFileError::ERROR_TRUNCATED,
+					"Error: unexpected end of file.");
+			return false;
+		}
+		uchar byte = *ptr++;
+		value = (value << 7) | (byte & 0x7f);
+		if (byte < 0x80) {
+			return true;
+		}
+	}
+	error.setError(MidiFileError::ERROR_VLV, "VLV number is too large");
+	return false;
+}
 
-ulong MidiFile::readVLValue(std::istream& input) {
-	uchar b[5] = {0};
 
-    for (uchar &item : b) {
-            item = readByte(input);
-            if (!status()) {
-                    return m_rwstatus;
-            }
-            if (item < 0x80) {
-                    break;
-            }
-    }
 
-    return unpackVLV(b[0], b[1], b[2], b[3], b[4]);
+//////////////////////////////
+//
+// MidiFile::forEachTrack -- Call a function for each track index.  The
+//    tracks are divided among the number of threads given by
+//    setTrackThreads(), so the function must only modify the given
+//    track.
+//
+
+void MidiFile::forEachTrack(const std::function<void(int)>& function) {
+	int tracks = getNumTracks();
+	int threadcount = m_trackThreads;
+	if (threadcount <= 0) {
+		threadcount = (int)std::thread::hardware_concurrency();
+	}
+	threadcount = std::min(threadcount, tracks);
+	if (threadcount <= 1) {
+		for (int i=0; i<tracks; i++) {
+			function(i);
+		}
+		return;
+	}
+
+	std::atomic<int> nexttrack(0);
+	auto worker = [&](void) {
+		int i;
+		while ((i = nexttrack++) < tracks) {
+			function(i);
+		}
+	};
+	std::vector<std::thread> threads;
+	for (int i=1; i<threadcount; i++) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (auto& thread : threads) {
+		thread.join();
+	}
 }
 
 
 
 //////////////////////////////
 //
-// MidiFile::unpackVLV -- converts a VLV value to an unsigned long value.
-//     The bytes a, b, c, d, e are in big-endian order (the order they would
-//     be read out of the MIDI file).
-// default values: a = b = c = d = 0;
+// MidiFile::readTracksParallel -- Decode the track chunks which start at
+//    the given pointer on several threads.  The track boundaries are
+//    found from the chunk sizes, and each track must end exactly at the
+//    end of its chunk.  Otherwise false is returned with all tracks
+//    empty, and the tracks should be read sequentially (which also
+//    reports any errors).  Each thread allocates events from its own
+//    arena, and the arenas are added to the MidiFile's arena afterwards.
 //
 
-ulong MidiFile::unpackVLV(uchar a, uchar b, uchar c, uchar d, uchar e) {
-	uchar bytes[5] = {a, b, c, d, e};
-	int count = 0;
-	while ((count < 5) && (bytes[count] > 0x7f)) {
-		count++;
+bool MidiFile::readTracksParallel(const uchar* ptr, const uchar* end,
+		int tracks) {
+	std::vector<const uchar*> starts(tracks);
+	std::vector<const uchar*> ends(tracks);
+	for (int i=0; i<tracks; i++) {
+		if ((end - ptr < 8) || (std::memcmp(ptr, "MTrk", 4) != 0)) {
+			return false;
+		}
+		ptr += 4;
+		ulong length = readBigEndian4Bytes(ptr);
+		if (length > (ulong)(end - ptr)) {
+			return false;
+		}
+		starts[i] = ptr;
+		ends[i] = ptr + length;
+		ptr = ends[i];
 	}
-	count++;
-	if (count >= 6) {
-		std::cerr << "VLV number is too large" << std::endl;
-		m_rwstatus = false;
-		return 0;
+
+	int threadcount = m_readThreads;
+	if (threadcount <= 0) {
+		threadcount = (int)std::thread::hardware_concurrency();
+	}
+	threadcount = std::max(1, std::min(threadcount, tracks));
+
+	std::vector<MidiEventArena> arenas(threadcount);
+	std::vector<char> successQ(tracks, 0);
+	std::atomic<int> nexttrack(0);
+
+	auto worker = [&](int index) {
+		int i;
+		while ((i = nexttrack++) < tracks) {
+			int length = (int)(ends[i] - starts[i]);
+			arenas[index].reserve(length / 4);
+			m_events[i]->reserve(length / 2);
+			const uchar* trackptr = starts[i];
+			MidiFileError error;
+			bool status = readTrackData(trackptr, ends[i], *m_events[i],
+					arenas[index], i, error);
+			successQ[i] = status && (trackptr == ends[i]);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i=1; i<threadcount; i++) {
+		threads.emplace_back(worker, i);
 	}
+	worker(0);
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	bool status = std::all_of(successQ.begin(), successQ.end(),
+			[](char value) { return value != 0; });
+	if (!status) {
+		for (int i=0; i<tracks; i++) {
+			m_events[i]->clear();
+		}
+		return false;
+	}
+	for (auto& arena : arenas) {
+		m_arena.append(arena);
+	}
+	return true;
+}
+
+
 
-	ulong output = 0;
-	for (int i=0; i<count; i++) {
-		output = output << 7;
-		output = output | (bytes[i] & 0x7f);
+//////////////////////////////
+//
+// MidiFile::checkChunkId -- Check that the next four bytes in a memory
+//    buffer match the expected chunk ID ("MThd" or "MTrk"), and advance
+//    the pointer past them.  The location string is added to error
+//    messages (such as " in track"), and the start of the buffer is
+//    used to calculate the error offset.
+//
+
+bool MidiFile::checkChunkId(const uchar*& ptr, const uchar* start,
+		const uchar* end, const char* id, const char* location) {
+	static const char* ordinal[4] = {"first", "second", "third", "fourth"};
+	std::string filename = getFilename();
+	for (int i=0; i<4; i++) {
+		if (ptr >= end) {
+			readError(MidiFileError(MidiFileError::ERROR_TRUNCATED,
+					"In file " + filename + ": unexpected end of file.\n"
+					"Expecting '" + id[i] + "' at " + ordinal[i] + " byte"
+					+ location + ", but found nothing.", ptr - start));
+			return false;
+		} else if (*ptr != (uchar)id[i]) {
+			readError(MidiFileError(MidiFileError::ERROR_CHUNK_ID,
+					"File " + filename + " is not a MIDI file\n"
+					"Expecting '" + id[i] + "' at " + ordinal[i] + " byte"
+					+ location + " but got '" + (char)*ptr + "'", ptr - start));
+			return false;
+		}
+		ptr++;
 	}
+	return true;
+}
+
 
+
+//////////////////////////////
+//
+// MidiFile::readBigEndian2Bytes -- Read a two-byte unsigned integer
+//    from a memory buffer and advance the pointer.  The calling function
+//    must check that there are enough bytes.
+//
+
+ushort MidiFile::readBigEndian2Bytes(const uchar*& ptr) {
+	ushort output = (ushort)((ptr[0] << 8) | ptr[1]);
+	ptr += 2;
 	return output;
 }
 
@@ -3038,98 +3525,324 @@ ulong MidiFile::unpackVLV(uchar a, uchar b, uchar c, uchar d, uchar e) {
 
 //////////////////////////////
 //
-// MidiFile::writeVLValue -- write a number to the midifile
-//    as a variable length value which segments a file into 7-bit
-//    values and adds a continuation bit to each.  Maximum size of input
-//    aValue is 0x0FFFffff.
+// MidiFile::readBigEndian4Bytes -- Read a four-byte unsigned integer
+//    from a memory buffer and advance the pointer.  The calling function
+//    must check that there are enough bytes.
 //
 
-void MidiFile::writeVLValue(long aValue, std::vector<uchar>& outdata) {
-	uchar bytes[4] = {0};
+ulong MidiFile::readBigEndian4Bytes(const uchar*& ptr) {
+	ulong output = ((ulong)ptr[0] << 24) | ((ulong)ptr[1] << 16) |
+			((ulong)ptr[2] << 8) | (ulong)ptr[3];
+	ptr += 4;
+	return output;
+}
 
-	if ((unsigned long)aValue >= (1 << 28)) {
-		std::cerr << "Error: number too large to convert to VLV" << std::endl;
-		aValue = 0x0FFFffff;
+
+
+//////////////////////////////
+//
+// MidiFile::getFileContents -- Read the entire contents of a file into
+//    a byte buffer.  Returns false if the file could not be opened.
+//
+
+bool MidiFile::getFileContents(const std::string& filename,
+		std::vector<uchar>& buffer) {
+	std::ifstream input(filename.c_str(), std::ios::binary | std::ios::in);
+	if (!input.is_open()) {
+		return false;
 	}
+	input.seekg(0, std::ios::end);
+	std::streamoff length = input.tellg();
+	input.seekg(0, std::ios::beg);
+	if ((length <= 0) || !input.good()) {
+		// Not a regular file (such as a pipe), so read until the end.
+		input.clear();
+		buffer.assign(std::istreambuf_iterator<char>(input),
+				std::istreambuf_iterator<char>());
+		return true;
+	}
+	buffer.resize((size_t)length);
+	input.read((char*)buffer.data(), length);
+	buffer.resize((size_t)input.gcount());
+	return true;
+}
+
 
-	bytes[0] = (uchar)(((ulong)aValue >> 21) & 0x7f);  // most significant 7 bits
-	bytes[1] = (uchar)(((ulong)aValue >> 14) & 0x7f);
-	bytes[2] = (uchar)(((ulong)aValue >> 7)  & 0x7f);
-	bytes[3] = (uchar)(((ulong)aValue)       & 0x7f);  // least significant 7 bits
 
-	int start = 0;
-	while ((start<4) && (bytes[start] == 0))  start++;
+//////////////////////////////
+//
+// MidiFile::readMappedFile -- Map a file into memory and parse it
+//    from the mapping with read() or readSmf() (if smfQ is true).
+//    Returns 1 if the file was read successfully and 0 if there was
+//    a parsing error.  Returns -1 without reading anything if the
+//    file cannot be mapped, such as when it is not a regular file.
+//
 
-	for (int i=start; i<3; i++) {
-		bytes[i] = bytes[i] | 0x80;
-		outdata.push_back(bytes[i]);
+int MidiFile::readMappedFile(const std::string& filename, bool smfQ) {
+#ifdef _WIN32
+	return -1;
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return -1;
+	}
+	struct stat info;
+	if ((fstat(fd, &info) != 0) || !S_ISREG(info.st_mode) || (info.st_size <= 0)) {
+		close(fd);
+		return -1;
 	}
-	outdata.push_back(bytes[3]);
+	size_t size = (size_t)info.st_size;
+	void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		return -1;
+	}
+	posix_madvise(mapping, size, POSIX_MADV_SEQUENTIAL);
+
+	const uchar* data = (const uchar*)mapping;
+	bool status = smfQ ? readSmf(data, size) : read(data, size);
+	munmap(mapping, size);
+	return status ? 1 : 0;
+#endif
 }
 
 
 
 //////////////////////////////
 //
-// MidiFile::clear_no_deallocate -- Similar to clear() but does not
-//   delete the Events in the lists.  This is primarily used internally
-//   to the MidiFile class, so don't use unless you really know what you
-//   are doing (otherwise you will end up with memory leaks or
-//   segmentation faults).
+// MidiFile::getTrackWriteSizes -- Calculate the size of each track chunk's
+//    data (excluding the 8-byte chunk header) when written to a file.
+//    Returns the total size of the file.
 //
 
-void MidiFile::clear_no_deallocate(void) {
-	for (int i=0; i<getTrackCount(); i++) {
-		m_events[i]->detach();
-		delete m_events[i];
-		m_events[i] = NULL;
+size_t MidiFile::getTrackWriteSizes(std::vector<ulong>& tracksizes) const {
+	int tracks = getNumTracks();
+	tracksizes.resize(tracks);
+	size_t output = 14;
+	for (int i=0; i<tracks; i++) {
+		tracksizes[i] = writeTrackData(i, NULL);
+		output += 8 + tracksizes[i];
 	}
-	m_events.resize(1);
-	m_events[0] = new MidiEventList;
-	m_timemapvalid=0;
-	m_timemap.clear();
-	// m_events.resize(0);   // causes a memory leak [20150205 Jorden Thatcher]
+	return output;
 }
 
 
 
 //////////////////////////////
 //
-// MidiFile::ticksearch -- for finding a tick entry in the time map.
+// MidiFile::writeTracks -- Write the header and track chunks of a
+//    Standard MIDI file into a buffer.  The track sizes are calculated
+//    by getTrackWriteSizes(), and the buffer must be large enough to
+//    hold the complete file.
 //
 
-int MidiFile::ticksearch(const void* A, const void* B) {
-	_TickTime& a = *((_TickTime*)A);
-	_TickTime& b = *((_TickTime*)B);
+void MidiFile::writeTracks(uchar* buffer,
+		const std::vector<ulong>& tracksizes) const {
+	uchar* ptr = buffer;
 
-	if (a.tick < b.tick) {
-		return -1;
-	} else if (a.tick > b.tick) {
-		return 1;
+	// 1. The characters "MThd"
+	// 2. The size of the header (always 6).
+	// 3. MIDI file format, type 0, 1, or 2
+	// 4. The number of tracks.
+	// 5. The number of ticks per quarternote. (avoiding SMPTE for now)
+	std::memcpy(ptr, "MThd", 4);
+	ptr += 4;
+	writeBigEndian4Bytes(ptr, 6);
+	writeBigEndian2Bytes(ptr, static_cast<ushort>(getNumTracks() == 1 ? 0 : 1));
+	writeBigEndian2Bytes(ptr, static_cast<ushort>(getNumTracks()));
+	writeBigEndian2Bytes(ptr, static_cast<ushort>(getTicksPerQuarterNote()));
+
+	// now write each track.
+	for (int i=0; i<getNumTracks(); i++) {
+		std::memcpy(ptr, "MTrk", 4);
+		ptr += 4;
+		writeBigEndian4Bytes(ptr, tracksizes[i]);
+		ptr += writeTrackData(i, ptr);
 	}
-	return 0;
 }
 
 
 
 //////////////////////////////
 //
-// MidiFile::secondsearch -- for finding a second entry in the time map.
+// MidiFile::writeTrackData -- Write the events of a track as track
+//    chunk data.  Returns the number of bytes.  If the output buffer
+//    is NULL, then only the size is calculated.  Empty events and
+//    end-of-track messages are skipped, and an end-of-track message is
+//    added at the end of the data.  Delta ticks are calculated from
+//    the event ticks if the tracks are in absolute tick mode.
 //
 
-int MidiFile::secondsearch(const void* A, const void* B) {
-	_TickTime& a = *((_TickTime*)A);
-	_TickTime& b = *((_TickTime*)B);
+ulong MidiFile::writeTrackData(int track, uchar* output) const {
+	const MidiEventList& eventlist = *m_events[track];
+	bool absoluteQ = getTickState() == TIME_STATE_ABSOLUTE;
+	int lasttick = 0;
+	ulong size = 0;
+
+	// The last three bytes of the track data, used to check if the data
+	// already ends with an end-of-track message.
+	uchar tail[3] = {0, 0, 0};
 
-	if (a.seconds < b.seconds) {
-		return -1;
-	} else if (a.seconds > b.seconds) {
+	auto append = [&](const uchar* data, ulong count) {
+		if (count == 0) {
+			return;
+		}
+		if (output) {
+			std::memcpy(output + size, data, count);
+		}
+		size += count;
+		if (count >= 3) {
+			std::memcpy(tail, data + count - 3, 3);
+		} else {
+			for (ulong i=0; i<count; i++) {
+				tail[0] = tail[1];
+				tail[1] = tail[2];
+				tail[2] = data[i];
+			}
+		}
+	};
+
+	uchar vlv[4];
+	int vlvsize;
+	for (int j=0; j<eventlist.size(); j++) {
+		const MidiEvent& event = eventlist[j];
+		int deltatick = event.tick;
+		if (absoluteQ) {
+			deltatick = event.tick - lasttick;
+			lasttick = event.tick;
+			if ((deltatick < 0) && output) {
+				std::cerr << "Error: negative delta tick value: " << deltatick << std::endl
+				     << "Timestamps must be sorted first"
+				     << " (use MidiFile::sortTracks() before writing)." << std::endl;
+			}
+		}
+		if (event.empty()) {
+			// Don't write empty m_events (probably a delete message).
+			continue;
+		}
+		if (event.isEndOfTrack()) {
+			// Suppress end-of-track meta messages (one will be added
+			// automatically after all track data has been written).
+			continue;
+		}
+		vlvsize = packVLValue(deltatick, vlv, output != NULL);
+		append(vlv, vlvsize);
+		if ((event[0] == 0xf0) || (event[0] == 0xf7)) {
+			// 0xf0 == Complete sysex message (0xf0 is part of the raw MIDI).
+			// 0xf7 == Raw byte message (0xf7 not part of the raw MIDI).
+			// Print the first byte of the message (0xf0 or 0xf7), then
+			// print a VLV length for the rest of the bytes in the message.
+			// In other words, when creating a 0xf0 or 0xf7 MIDI message,
+			// do not insert the VLV byte length yourself, as this code will
+			// do it for you automatically.
+			append(event.data(), 1);
+			vlvsize = packVLValue((long)event.size() - 1, vlv, output != NULL);
+			append(vlv, vlvsize);
+			append(event.data() + 1, event.size() - 1);
+		} else {
+			// non-sysex type of message, so just output the
+			// bytes of the message:
+			append(event.data(), event.size());
+		}
+	}
+
+	if ((size < 3) || !((tail[0] == 0xff) && (tail[1] == 0x2f))) {
+		static const uchar endoftrack[4] = {0, 0xff, 0x2f, 0x00};
+		append(endoftrack, 4);
+	}
+
+	return size;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::packVLValue -- Store a number as a variable length value
+//    (as in writeVLValue()) in the given four-byte buffer.  Returns
+//    the number of bytes used.  Numbers larger than 0x0FFFffff are
+//    clamped, with an error message printed if reportQ is true.
+//
+
+int MidiFile::packVLValue(long aValue, uchar* bytes, bool reportQ) {
+	if ((unsigned long)aValue >= (1 << 28)) {
+		if (reportQ) {
+			std::cerr << "Error: number too large to convert to VLV" << std::endl;
+		}
+		aValue = 0x0FFFffff;
+	}
+	ulong value = (ulong)aValue;
+	if (value < 0x80) {
+		bytes[0] = (uchar)value;
 		return 1;
 	}
-	return 0;
+	int count = 0;
+	for (int shift=21; shift>0; shift-=7) {
+		uchar byte = (uchar)((value >> shift) & 0x7f);
+		if (count || byte) {
+			bytes[count++] = byte | 0x80;
+		}
+	}
+	bytes[count++] = (uchar)(value & 0x7f);
+	return count;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::writeBigEndian2Bytes -- Store a two-byte number in a memory
+//    buffer, most significant byte first, and advance the pointer.
+//
+
+void MidiFile::writeBigEndian2Bytes(uchar*& ptr, ushort value) {
+	ptr[0] = (uchar)((value >> 8) & 0xff);
+	ptr[1] = (uchar)(value & 0xff);
+	ptr += 2;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::writeBigEndian4Bytes -- Store a four-byte number in a memory
+//    buffer, most significant byte first, and advance the pointer.
+//
+
+void MidiFile::writeBigEndian4Bytes(uchar*& ptr, ulong value) {
+	ptr[0] = (uchar)((value >> 24) & 0xff);
+	ptr[1] = (uchar)((value >> 16) & 0xff);
+	ptr[2] = (uchar)((value >> 8) & 0xff);
+	ptr[3] = (uchar)(value & 0xff);
+	ptr += 4;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::clear_no_deallocate -- Similar to clear() but does not
+//   delete the Events in the lists.  This is primarily used internally
+//   to the MidiFile class, so don't use unless you really know what you
+//   are doing (otherwise you will end up with memory leaks or
+//   segmentation faults).
+//
+
+void MidiFile::clear_no_deallocate(void) {
+	for (int i=0; i<getTrackCount(); i++) {
+		m_events[i]->detach();
+		delete m_events[i];
+		m_events[i] = NULL;
+	}
+	m_events.resize(1);
+	m_events[0] = new MidiEventList;
+	m_timemapdirty = 0;
+	m_timemap.clear();
+	// m_events.resize(0);   // causes a memory leak [20150205 Jorden Thatcher]
 }
 
 
+
 ///////////////////////////////////////////////////////////////////////////
 //
 // Static functions:
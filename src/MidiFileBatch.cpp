@@ -0,0 +1,327 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 15:36:44 PDT 2026
+// Last Modified: Sat Oct 17 16:05:12 PDT 2026 Store MidiFileError for each file.
+// Filename:      midifile/src/MidiFileBatch.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Read a list of MIDI files with a pool of worker threads.
+//
+
+#include "MidiFileBatch.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// MidiFileBatch::MidiFileBatch -- Constructor.
+//
+
+MidiFileBatch::MidiFileBatch(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::~MidiFileBatch -- Deconstructor.
+//
+
+MidiFileBatch::~MidiFileBatch() {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::setThreadCount -- Set the number of worker threads used
+//     to read files.  A value of 0 (the default) uses one thread for each
+//     hardware thread.
+//
+
+void MidiFileBatch::setThreadCount(int count) {
+	m_threadCount = count < 0 ? 0 : count;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::getThreadCount -- Return the number of worker threads
+//     (0 means one per hardware thread).
+//
+
+int MidiFileBatch::getThreadCount(void) const {
+	return m_threadCount;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::setKeepFiles -- Keep the contents of each MidiFile after
+//     reading (the default).  When turned off, each MidiFile is cleared
+//     after the callback function has processed it, so that only the
+//     status and error messages are kept.
+//
+
+void MidiFileBatch::setKeepFiles(bool state) {
+	m_keepFilesQ = state;
+}
+
+
+void MidiFileBatch::setKeepFilesOn(void) {
+	setKeepFiles(true);
+}
+
+
+void MidiFileBatch::setKeepFilesOff(void) {
+	setKeepFiles(false);
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::getKeepFiles -- Return true if MidiFile contents are kept.
+//
+
+bool MidiFileBatch::getKeepFiles(void) const {
+	return m_keepFilesQ;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::setCallback -- Set a function to call after each file is
+//     read.  The function is called from the worker thread that read
+//     the file, so it must be thread-safe.
+//
+
+void MidiFileBatch::setCallback(Callback callback) {
+	m_callback = callback;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::read -- Read a list of MIDI files.  The results are
+//     stored in the same order as the filenames.  Returns true if all
+//     files were read successfully.
+//
+//     Work is handed out largest file first from a shared counter, so
+//     a large file is not left until the end while the other threads
+//     sit idle.
+//
+
+bool MidiFileBatch::read(const std::vector<std::string>& filenames) {
+	clear();
+	int count = (int)filenames.size();
+	m_filenames = filenames;
+	m_files.resize(count);
+	for (int i=0; i<count; i++) {
+		m_files[i] = new MidiFile;
+		m_files[i]->setErrorPrintingOff();
+	}
+	m_status.assign(count, 0);
+	m_errors.assign(count, MidiFileError());
+
+	std::vector<std::pair<long long, int>> order(count);
+	for (int i=0; i<count; i++) {
+		struct stat info;
+		long long filesize = 0;
+		if (stat(filenames[i].c_str(), &info) == 0) {
+			filesize = (long long)info.st_size;
+		}
+		order[i] = std::make_pair(-filesize, i);
+	}
+	std::sort(order.begin(), order.end());
+
+	int threads = m_threadCount;
+	if (threads <= 0) {
+		threads = (int)std::thread::hardware_concurrency();
+	}
+	if (threads <= 0) {
+		threads = 1;
+	}
+	threads = std::min(threads, count);
+
+	std::atomic<int> next(0);
+	auto worker = [&]() {
+		while (true) {
+			int i = next++;
+			if (i >= count) {
+				break;
+			}
+			readFile(order[i].second);
+		}
+	};
+
+	if (threads <= 1) {
+		worker();
+	} else {
+		std::vector<std::thread> pool;
+		pool.reserve(threads - 1);
+		for (int i=0; i<threads - 1; i++) {
+			pool.emplace_back(worker);
+		}
+		worker();
+		for (auto& thread : pool) {
+			thread.join();
+		}
+	}
+
+	return getErrorCount() == 0;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::clear -- Remove all files.
+//
+
+void MidiFileBatch::clear(void) {
+	for (auto file : m_files) {
+		delete file;
+	}
+	m_files.clear();
+	m_filenames.clear();
+	m_status.clear();
+	m_errors.clear();
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::getFileCount -- Return the number of files in the batch.
+//
+
+int MidiFileBatch::getFileCount(void) const {
+	return (int)m_files.size();
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::getFile -- Return the MidiFile read from the given index
+//     in the list of filenames.
+//
+
+MidiFile& MidiFileBatch::getFile(int index) {
+	return *m_files.at(index);
+}
+
+
+const MidiFile& MidiFileBatch::getFile(int index) const {
+	return *m_files.at(index);
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::getStatus -- Return true if the file was read successfully.
+//
+
+bool MidiFileBatch::getStatus(int index) const {
+	return m_status.at(index) != 0;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::getFilename -- Return the filename at the given index.
+//
+
+const std::string& MidiFileBatch::getFilename(int index) const {
+	return m_filenames.at(index);
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::getError -- Return the read error for a file (with
+//     the code MidiFileError::ERROR_NONE if it was read successfully).
+//
+
+const MidiFileError& MidiFileBatch::getError(int index) const {
+	return m_errors.at(index);
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::getErrorMessage -- Return the read error message for a
+//     file, or an empty string if it was read successfully.
+//
+
+const std::string& MidiFileBatch::getErrorMessage(int index) const {
+	return m_errors.at(index).getMessage();
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileBatch::getErrorCount -- Return the number of files which could
+//     not be read.
+//
+
+int MidiFileBatch::getErrorCount(void) const {
+	int output = 0;
+	for (auto status : m_status) {
+		if (!status) {
+			output++;
+		}
+	}
+	return output;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// MidiFileBatch::readFile -- Read one file from a worker thread.
+//
+
+void MidiFileBatch::readFile(int index) {
+	MidiFile& midifile = *m_files[index];
+	bool status = midifile.read(m_filenames[index]);
+	m_status[index] = status ? 1 : 0;
+	m_errors[index] = midifile.getError();
+	if (m_callback) {
+		m_callback(index, midifile, status);
+	}
+	if (!m_keepFilesQ) {
+		midifile.clear();
+	}
+}
+
+
+} // end of namespace smf
+
+
+
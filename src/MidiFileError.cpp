@@ -0,0 +1,203 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 16:05:12 PDT 2026
+// Last Modified: Sat Oct 17 16:05:12 PDT 2026
+// Filename:      midifile/src/MidiFileError.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Description of a problem found while reading a MIDI file.
+//
+
+#include "MidiFileError.h"
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// MidiFileError::MidiFileError -- Constructor.
+//
+
+MidiFileError::MidiFileError(void) {
+	// do nothing
+}
+
+
+MidiFileError::MidiFileError(ErrorCode code, const std::string& message,
+		long offset, int track) {
+	m_code    = code;
+	m_message = message;
+	m_offset  = offset;
+	m_track   = track;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileError::~MidiFileError -- Deconstructor.
+//
+
+MidiFileError::~MidiFileError() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileError::clear -- Reset to the no-error state.
+//
+
+void MidiFileError::clear(void) {
+	m_code   = ERROR_NONE;
+	m_offset = -1;
+	m_track  = -1;
+	m_message.clear();
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileError::setError -- Set the error code and message.
+//
+
+void MidiFileError::setError(ErrorCode code, const std::string& message) {
+	m_code    = code;
+	m_message = message;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileError::setOffset -- Set the byte offset of the error in the file.
+//
+
+void MidiFileError::setOffset(long offset) {
+	m_offset = offset;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileError::setTrack -- Set the track where the error occurred.
+//
+
+void MidiFileError::setTrack(int track) {
+	m_track = track;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileError::isError -- Returns true if an error has been set.
+//
+
+bool MidiFileError::isError(void) const {
+	return m_code != ERROR_NONE;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileError::getCode -- Returns the error code.
+//
+
+MidiFileError::ErrorCode MidiFileError::getCode(void) const {
+	return m_code;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileError::getCodeName -- Returns a short name for the error code,
+//     suitable for grouping errors in reports.
+//
+
+const char* MidiFileError::getCodeName(void) const {
+	switch (m_code) {
+		case ERROR_NONE:           return "none";
+		case ERROR_OPEN:           return "open";
+		case ERROR_BAD_INPUT:      return "bad-input";
+		case ERROR_TRUNCATED:      return "truncated";
+		case ERROR_CHUNK_ID:       return "chunk-id";
+		case ERROR_HEADER_SIZE:    return "header-size";
+		case ERROR_FILE_TYPE:      return "file-type";
+		case ERROR_TRACK_COUNT:    return "track-count";
+		case ERROR_RUNNING_STATUS: return "running-status";
+		case ERROR_DATA_BYTE:      return "data-byte";
+		case ERROR_VLV:            return "vlv";
+		case ERROR_COMMAND_BYTE:   return "command-byte";
+	}
+	return "unknown";
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileError::getOffset -- Returns the byte offset in the file where
+//     the error was found, or -1 if not known.
+//
+
+long MidiFileError::getOffset(void) const {
+	return m_offset;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileError::getTrack -- Returns the index of the track which was
+//     being read, or -1 if the error was not inside of a track.
+//
+
+int MidiFileError::getTrack(void) const {
+	return m_track;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileError::getMessage -- Returns the text description of the error.
+//
+
+const std::string& MidiFileError::getMessage(void) const {
+	return m_message;
+}
+
+
+
+//////////////////////////////
+//
+// operator<< -- Print the error message followed by its location.
+//
+
+std::ostream& operator<<(std::ostream& out, const MidiFileError& error) {
+	out << error.getMessage();
+	if (error.getTrack() >= 0) {
+		out << " (track " << error.getTrack();
+		if (error.getOffset() >= 0) {
+			out << ", byte " << error.getOffset();
+		}
+		out << ")";
+	} else if (error.getOffset() >= 0) {
+		out << " (byte " << error.getOffset() << ")";
+	}
+	return out;
+}
+
+
+} // end of namespace smf
+
+
+
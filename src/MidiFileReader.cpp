@@ -0,0 +1,726 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 17:42:08 PDT 2026
+// Last Modified: Sat Oct 17 17:42:08 PDT 2026
+// Filename:      midifile/src/MidiFileReader.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   A streaming reader for Standard MIDI Files which returns
+//                one event at a time.
+//
+
+#include "MidiFileReader.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+
+namespace smf {
+
+// Number of bytes read from a stream at a time for each track.
+static const long WINDOW_SIZE = 4096;
+
+
+//////////////////////////////
+//
+// MidiFileReader::MidiFileReader -- Constructor.
+//
+
+MidiFileReader::MidiFileReader(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::~MidiFileReader -- Deconstructor.
+//
+
+MidiFileReader::~MidiFileReader() {
+	close();
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::setMergedOrder -- Return events in chronological order
+//     across all tracks (merged order), or track by track in the order
+//     they are stored in the file (the default).  Merged order reads the
+//     tracks in parallel, so it requires the chunk sizes in the file to
+//     be correct, and stream input must be seekable.  Events at the same
+//     tick are returned in track order.  Must be set before open().
+//
+
+void MidiFileReader::setMergedOrder(bool state) {
+	m_mergedQ = state;
+}
+
+
+void MidiFileReader::setMergedOrderOn(void) {
+	setMergedOrder(true);
+}
+
+
+void MidiFileReader::setMergedOrderOff(void) {
+	setMergedOrder(false);
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::getMergedOrder -- Returns true if events are read in
+//     merged order.
+//
+
+bool MidiFileReader::getMergedOrder(void) const {
+	return m_mergedQ;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::open -- Open a Standard MIDI File for reading from a
+//     file, stream or memory buffer, and read the header.  Stream and
+//     buffer input must remain valid until the reader is closed.  Binasc
+//     content is not accepted (use MidiFile::read() for that).  Returns
+//     false if the header could not be read.
+//
+
+bool MidiFileReader::open(const std::string& filename) {
+	close();
+	m_file.open(filename.c_str(), std::ios::binary | std::ios::in);
+	if (!m_file.is_open()) {
+		m_error = MidiFileError(MidiFileError::ERROR_OPEN,
+				"Error: could not open file " + filename);
+		return false;
+	}
+	m_input = &m_file;
+	return openInput();
+}
+
+
+bool MidiFileReader::open(std::istream& input) {
+	close();
+	m_input = &input;
+	return openInput();
+}
+
+
+bool MidiFileReader::open(const uchar* data, size_t size) {
+	close();
+	m_data = data;
+	m_size = size;
+	return openInput();
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::close -- Stop reading the current input.
+//
+
+void MidiFileReader::close(void) {
+	if (m_file.is_open()) {
+		m_file.close();
+	}
+	m_file.clear();
+	m_data       = NULL;
+	m_size       = 0;
+	m_input      = NULL;
+	m_origin     = 0;
+	m_main       = _TrackCursor();
+	m_tracks.clear();
+	m_heap.clear();
+	m_track      = -1;
+	m_type       = 0;
+	m_trackCount = 0;
+	m_ticksPerQuarterNote = 0;
+	m_error.clear();
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::readEvent -- Read the next event of the file.  The
+//     tick of the event is in absolute ticks, and the track is the
+//     track chunk it was read from.  End-of-track meta messages are
+//     included.  Returns false when there are no more events, or if
+//     there was an error reading the event (check status() or
+//     getError() to tell the difference).
+//
+
+bool MidiFileReader::readEvent(MidiEvent& event) {
+	if (m_error.isError() || ((m_data == NULL) && (m_input == NULL))) {
+		return false;
+	}
+	if (m_mergedQ) {
+		return readMergedEvent(event);
+	}
+	while (true) {
+		if ((m_track >= 0) && readTrackEvent(m_main, m_track, event)) {
+			return true;
+		}
+		if (m_error.isError() || (m_track + 1 >= m_trackCount)) {
+			return false;
+		}
+		m_track++;
+		if (!startTrack(m_main)) {
+			return false;
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::getFileType -- Returns the MIDI file type (0 or 1).
+//
+
+int MidiFileReader::getFileType(void) const {
+	return m_type;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::getTrackCount -- Returns the number of tracks in the file.
+//
+
+int MidiFileReader::getTrackCount(void) const {
+	return m_trackCount;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::getTicksPerQuarterNote -- Returns the tick resolution
+//     given in the header of the file.
+//
+
+int MidiFileReader::getTicksPerQuarterNote(void) const {
+	return m_ticksPerQuarterNote;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::status -- Returns false if there was an error.
+//
+
+bool MidiFileReader::status(void) const {
+	return !m_error.isError();
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::getError -- Returns a description of the last error.
+//
+
+const MidiFileError& MidiFileReader::getError(void) const {
+	return m_error;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// MidiFileReader::openInput -- Prepare the main cursor for the input
+//     and read the header.  In merged order, also locate the track
+//     chunks and read the first event of each track.
+//
+
+bool MidiFileReader::openInput(void) {
+	if (m_data) {
+		m_main.first  = m_data;
+		m_main.ptr    = m_data;
+		m_main.stop   = m_data + m_size;
+		m_main.end    = (long)m_size;
+	} else {
+		m_origin      = m_input->tellg();
+		m_main.end    = LONG_MAX;
+	}
+
+	if (!readHeader()) {
+		return false;
+	}
+	if (!m_mergedQ) {
+		return true;
+	}
+	if (!findTracks()) {
+		return false;
+	}
+
+	m_heap.reserve(m_trackCount);
+	for (int i=0; i<m_trackCount; i++) {
+		if (readTrackEvent(m_tracks[i], i, m_tracks[i].event)) {
+			m_heap.push_back(i);
+		} else if (m_error.isError()) {
+			return false;
+		}
+	}
+	std::make_heap(m_heap.begin(), m_heap.end(),
+			[this](int a, int b) { return heapCompare(a, b); });
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::readHeader -- Read the MThd chunk of the file.
+//
+
+bool MidiFileReader::readHeader(void) {
+	std::vector<uchar> header;
+	header.reserve(14);
+	bool completeQ = getBytes(m_main, 14, header);
+	if (!header.empty() &&
+			(std::memcmp(header.data(), "MThd", std::min((int)header.size(), 4)) != 0)) {
+		setError(MidiFileError::ERROR_CHUNK_ID, "Error: input is not a MIDI file",
+				0);
+		return false;
+	}
+	if (!completeQ) {
+		setError(MidiFileError::ERROR_TRUNCATED,
+				"Error: unexpected end of file.\nExpecting a 14-byte header.",
+				getOffset(m_main));
+		return false;
+	}
+
+	const uchar* ptr = header.data();
+	ulong headersize = ((ulong)ptr[4] << 24) | (ptr[5] << 16) | (ptr[6] << 8) | ptr[7];
+	int type         = (ptr[8] << 8) | ptr[9];
+	int tracks       = (ptr[10] << 8) | ptr[11];
+	int division     = (ptr[12] << 8) | ptr[13];
+
+	if (headersize != 6) {
+		setError(MidiFileError::ERROR_HEADER_SIZE,
+				"Error: input is not a MIDI 1.0 Standard MIDI file.\n"
+				"The header size is " + std::to_string(headersize) + " bytes.", 4);
+		return false;
+	}
+	if ((type != 0) && (type != 1)) {
+		setError(MidiFileError::ERROR_FILE_TYPE, "Error: cannot handle a type-"
+				+ std::to_string(type) + " MIDI file", 8);
+		return false;
+	}
+	if ((type == 0) && (tracks != 1)) {
+		setError(MidiFileError::ERROR_TRACK_COUNT,
+				"Error: Type 0 MIDI file can only contain one track\n"
+				"Instead track count is: " + std::to_string(tracks), 10);
+		return false;
+	}
+
+	m_type = type;
+	m_trackCount = tracks;
+	if (division >= 0x8000) {
+		// SMPTE ticks (see MidiFile::readSmf()).
+		int framespersecond = 255 - ((division >> 8) & 0x00ff) + 1;
+		int subframes       = division & 0x00ff;
+		m_ticksPerQuarterNote = framespersecond * subframes;
+	} else {
+		m_ticksPerQuarterNote = division;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::findTracks -- Locate the track chunks from their chunk
+//     sizes, and set up a cursor for each track (for merged order).
+//
+
+bool MidiFileReader::findTracks(void) {
+	if (m_input && (m_origin < 0)) {
+		setError(MidiFileError::ERROR_BAD_INPUT,
+				"Error: merged order requires a seekable input stream", -1);
+		return false;
+	}
+
+	m_tracks.resize(m_trackCount);
+	long offset = 14;
+	uchar chunk[8];
+	for (int i=0; i<m_trackCount; i++) {
+		int count = 0;
+		if (m_data) {
+			count = (int)std::min((long)8, std::max((long)0, (long)m_size - offset));
+			std::memcpy(chunk, m_data + offset, count);
+		} else {
+			m_input->clear();
+			m_input->seekg(m_origin + offset);
+			m_input->read((char*)chunk, 8);
+			count = (int)m_input->gcount();
+		}
+		if (count < 8) {
+			setError(MidiFileError::ERROR_TRUNCATED,
+					"Error: unexpected end of file.\nExpecting a track chunk.",
+					offset + count, i);
+			return false;
+		}
+		if (std::memcmp(chunk, "MTrk", 4) != 0) {
+			setError(MidiFileError::ERROR_CHUNK_ID,
+					"Error: expecting 'MTrk' at start of track chunk", offset, i);
+			return false;
+		}
+		long length = ((long)chunk[4] << 24) | (chunk[5] << 16) | (chunk[6] << 8) | chunk[7];
+		_TrackCursor& cursor = m_tracks[i];
+		cursor.offset = offset + 8;
+		cursor.end    = offset + 8 + length;
+		if (m_data) {
+			if (cursor.end > (long)m_size) {
+				cursor.end = (long)m_size;
+			}
+			cursor.first = m_data + cursor.offset;
+			cursor.ptr   = cursor.first;
+			cursor.stop  = m_data + cursor.end;
+		}
+		offset += 8 + length;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::startTrack -- Read the header of the next track chunk
+//     (for track-by-track order).  As in MidiFile::readSmf(), the chunk
+//     size is ignored, since a track ends with its end-of-track message.
+//
+
+bool MidiFileReader::startTrack(_TrackCursor& cursor) {
+	std::vector<uchar> chunk;
+	chunk.reserve(8);
+	long offset = getOffset(cursor);
+	bool completeQ = getBytes(cursor, 8, chunk);
+	if (!chunk.empty() &&
+			(std::memcmp(chunk.data(), "MTrk", std::min((int)chunk.size(), 4)) != 0)) {
+		setError(MidiFileError::ERROR_CHUNK_ID,
+				"Error: expecting 'MTrk' at start of track chunk", offset, m_track);
+		return false;
+	}
+	if (!completeQ) {
+		setError(MidiFileError::ERROR_TRUNCATED,
+				"Error: unexpected end of file.\nExpecting a track chunk.",
+				getOffset(cursor), m_track);
+		return false;
+	}
+	cursor.tick    = 0;
+	cursor.running = 0;
+	cursor.doneQ   = false;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::readTrackEvent -- Read the next event of a track (see
+//     MidiFile::extractMidiData()).  Returns false if the end-of-track
+//     message has already been read, or if there is an error.
+//
+
+bool MidiFileReader::readTrackEvent(_TrackCursor& cursor, int track,
+		MidiEvent& event) {
+	if (cursor.doneQ) {
+		return false;
+	}
+
+	ulong value;
+	uchar byte;
+	bool runningQ;
+	if (!getVLValue(cursor, value, track) || !getByte(cursor, byte)) {
+		if (!m_error.isError()) {
+			setError(MidiFileError::ERROR_TRUNCATED,
+					"Error: unexpected end of file.", getOffset(cursor), track);
+		}
+		return false;
+	}
+	cursor.tick += (int)value;
+
+	if (byte < 0x80) {
+		runningQ = true;
+		if (cursor.running == 0) {
+			setError(MidiFileError::ERROR_RUNNING_STATUS,
+					"Error: running command with no previous command",
+					getOffset(cursor) - 1, track);
+			return false;
+		}
+		if (cursor.running >= 0xf0) {
+			setError(MidiFileError::ERROR_RUNNING_STATUS,
+					"Error: running status not permitted with meta and sysex event.",
+					getOffset(cursor) - 1, track);
+			return false;
+		}
+	} else {
+		cursor.running = byte;
+		runningQ = false;
+	}
+
+	uchar command = cursor.running;
+	bool completeQ = true;
+	event.assign(1, command);
+	switch (command & 0xf0) {
+		case 0xf0:
+			if (command == 0xff) {
+				// meta message: type, VLV length and data as in the file.
+				completeQ = getByte(cursor, byte);
+				if (completeQ) {
+					event.push_back(byte);
+					completeQ = getVLValue(cursor, value, track, &event) &&
+							getBytes(cursor, value, event);
+				}
+			} else if ((command == 0xf0) || (command == 0xf7)) {
+				// system exclusive or raw bytes: VLV length is not stored.
+				completeQ = getVLValue(cursor, value, track) &&
+						getBytes(cursor, value, event);
+			}
+			break;
+
+		default:
+			{
+			// channel message
+			int count = 2;
+			if (((command & 0xf0) == 0xc0) || ((command & 0xf0) == 0xd0)) {
+				count = 1;
+			}
+			if (runningQ) {
+				event.push_back(byte);
+				count--;
+			}
+			for (int i=0; i<count; i++) {
+				if (!getByte(cursor, byte)) {
+					completeQ = false;
+					break;
+				}
+				if (byte > 0x7f) {
+					setError(MidiFileError::ERROR_DATA_BYTE,
+							"MIDI data byte too large: " + std::to_string((int)byte),
+							getOffset(cursor) - 1, track);
+					return false;
+				}
+				event.push_back(byte);
+			}
+			}
+	}
+
+	if (!completeQ) {
+		if (!m_error.isError()) {
+			setError(MidiFileError::ERROR_TRUNCATED,
+					"Error: unexpected end of file.", getOffset(cursor), track);
+		}
+		return false;
+	}
+
+	event.tick  = cursor.tick;
+	event.track = track;
+	if ((event.size() >= 2) && (event[0] == 0xff) && (event[1] == 0x2f)) {
+		cursor.doneQ = true;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::readMergedEvent -- Return the earliest of the next
+//     events of each track, and read the following event of that track.
+//
+
+bool MidiFileReader::readMergedEvent(MidiEvent& event) {
+	if (m_heap.empty()) {
+		return false;
+	}
+	auto compare = [this](int a, int b) { return heapCompare(a, b); };
+	std::pop_heap(m_heap.begin(), m_heap.end(), compare);
+	int track = m_heap.back();
+	_TrackCursor& cursor = m_tracks[track];
+
+	event.assign(cursor.event.begin(), cursor.event.end());
+	event.tick  = cursor.event.tick;
+	event.track = cursor.event.track;
+
+	if (readTrackEvent(cursor, track, cursor.event)) {
+		std::push_heap(m_heap.begin(), m_heap.end(), compare);
+	} else {
+		// End of track, or an error which will be reported by
+		// the next call to readEvent().
+		m_heap.pop_back();
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::fillWindow -- Read the next block of stream input for
+//     a cursor.  Track cursors seek to their position in the stream,
+//     while the main cursor reads sequentially.  Returns false if there
+//     is no more data for the cursor.
+//
+
+bool MidiFileReader::fillWindow(_TrackCursor& cursor) {
+	if (m_data) {
+		// The window already contains all of the data.
+		return false;
+	}
+	long offset = cursor.offset + (long)(cursor.stop - cursor.first);
+	long count = std::min(WINDOW_SIZE, cursor.end - offset);
+	if (count <= 0) {
+		return false;
+	}
+	if (&cursor != &m_main) {
+		m_input->clear();
+		m_input->seekg(m_origin + offset);
+	}
+	cursor.window.resize(count);
+	m_input->read((char*)cursor.window.data(), count);
+	count = (long)m_input->gcount();
+	if (count <= 0) {
+		return false;
+	}
+	cursor.first  = cursor.window.data();
+	cursor.ptr    = cursor.first;
+	cursor.stop   = cursor.first + count;
+	cursor.offset = offset;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::getByte -- Read one byte of input for a cursor.
+//
+
+bool MidiFileReader::getByte(_TrackCursor& cursor, uchar& byte) {
+	if ((cursor.ptr == cursor.stop) && !fillWindow(cursor)) {
+		return false;
+	}
+	byte = *cursor.ptr++;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::getBytes -- Append the given number of input bytes for
+//     a cursor to the output.  Returns false if the input ends first.
+//
+
+bool MidiFileReader::getBytes(_TrackCursor& cursor, ulong count,
+		std::vector<uchar>& output) {
+	while (count > 0) {
+		if ((cursor.ptr == cursor.stop) && !fillWindow(cursor)) {
+			return false;
+		}
+		ulong available = (ulong)(cursor.stop - cursor.ptr);
+		ulong length = std::min(count, available);
+		output.insert(output.end(), cursor.ptr, cursor.ptr + length);
+		cursor.ptr += length;
+		count -= length;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::getVLValue -- Read a VLV value of up to five bytes
+//     (see MidiFile::readVLValue()).  The bytes are appended to the output
+//     if it is not NULL.
+//
+
+bool MidiFileReader::getVLValue(_TrackCursor& cursor, ulong& value,
+		int track, std::vector<uchar>* output) {
+	value = 0;
+	uchar byte;
+	for (int i=0; i<5; i++) {
+		if (!getByte(cursor, byte)) {
+			return false;
+		}
+		if (output) {
+			output->push_back(byte);
+		}
+		value = (value << 7) | (byte & 0x7f);
+		if (byte < 0x80) {
+			return true;
+		}
+	}
+	setError(MidiFileError::ERROR_VLV, "VLV number is too large",
+			getOffset(cursor), track);
+	return false;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::getOffset -- Returns the offset in the file of the next
+//     byte for the cursor.
+//
+
+long MidiFileReader::getOffset(const _TrackCursor& cursor) const {
+	return cursor.offset + (long)(cursor.ptr - cursor.first);
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::setError -- Store a description of a read error.
+//
+
+void MidiFileReader::setError(MidiFileError::ErrorCode code,
+		const std::string& message, long offset, int track) {
+	m_error = MidiFileError(code, message, offset, track);
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileReader::heapCompare -- Ordering of tracks in the merge heap:
+//     the track with the earliest next event (or lowest track number for
+//     equal ticks) is at the top of the heap.
+//
+
+bool MidiFileReader::heapCompare(int a, int b) const {
+	int ticka = m_tracks[a].event.tick;
+	int tickb = m_tracks[b].event.tick;
+	if (ticka != tickb) {
+		return ticka > tickb;
+	}
+	return a > b;
+}
+
+
+} // end of namespace smf
+
+
+
@@ -0,0 +1,451 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 18:20:36 PDT 2026
+// Last Modified: Sat Oct 17 18:20:36 PDT 2026
+// Filename:      midifile/src/MidiFileWriter.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   A streaming writer for Standard MIDI Files.
+//
+
+#include "MidiFileWriter.h"
+#include "MidiFile.h"
+
+#include <iostream>
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// MidiFileWriter::MidiFileWriter -- Constructor.
+//
+
+MidiFileWriter::MidiFileWriter(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::~MidiFileWriter -- Deconstructor.  Finishes the file
+//     if it has not been closed.
+//
+
+MidiFileWriter::~MidiFileWriter() {
+	close();
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::open -- Start writing a Standard MIDI File to a file or
+//     an output stream, with the given ticks per quarter note.  The
+//     stream must remain valid until close() is called.
+//     Default value: tpq = 120
+//
+
+bool MidiFileWriter::open(const std::string& filename, int tpq) {
+	close();
+	m_file.open(filename.c_str(), std::ios::binary | std::ios::out |
+			std::ios::trunc);
+	if (!m_file.is_open()) {
+		writeError("Error: could not write: " + filename);
+		return m_rwstatus;
+	}
+	m_out = &m_file;
+	return openStream(tpq);
+}
+
+
+bool MidiFileWriter::open(std::ostream& out, int tpq) {
+	close();
+	m_out = &out;
+	return openStream(tpq);
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::close -- Finish the current track, store the final track
+//     count in the header (seekable output), and flush the output.
+//     Returns false if there was any problem writing the file.
+//
+
+bool MidiFileWriter::close(void) {
+	if (m_out == NULL) {
+		return m_rwstatus;
+	}
+	if (m_trackOpenQ) {
+		endTrack();
+	}
+	if (!m_headerQ) {
+		writeHeader();
+	}
+
+	if (m_seekableQ) {
+		uchar data[4];
+		storeBigEndian(data, m_tracks == 1 ? 0 : 1, 2);
+		storeBigEndian(data + 2, m_tracks, 2);
+		std::streampos endpos = m_out->tellp();
+		m_out->seekp(m_headerPos + (std::streamoff)8);
+		m_out->write((const char*)data, 4);
+		m_out->seekp(endpos);
+	} else if (m_tracks != m_declaredTracks) {
+		writeError("Error: " + std::to_string(m_tracks) + " tracks written,"
+				" but header track count is " + std::to_string(m_declaredTracks));
+	}
+
+	m_out->flush();
+	if (m_out->fail()) {
+		writeError("Error: could not write MIDI file");
+	}
+	if (m_file.is_open()) {
+		m_file.close();
+	}
+	m_file.clear();
+	m_out            = NULL;
+	m_headerQ        = false;
+	m_declaredTracks = -1;
+	m_buffer.clear();
+	return m_rwstatus;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::setTrackCount -- Set the number of tracks which will be
+//     written.  This is required for non-seekable outputs (before the
+//     first track is started), since the header is written before the
+//     tracks.  For seekable outputs the header is updated by close().
+//
+
+void MidiFileWriter::setTrackCount(int count) {
+	m_declaredTracks = count;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::getTrackCount -- Returns the number of tracks started.
+//
+
+int MidiFileWriter::getTrackCount(void) const {
+	return m_tracks;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::getTicksPerQuarterNote -- Returns the tick resolution
+//     of the file being written.
+//
+
+int MidiFileWriter::getTicksPerQuarterNote(void) const {
+	return m_ticksPerQuarterNote;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::startTrack -- Start a new track chunk (finishing the
+//     current track if there is one).
+//
+
+bool MidiFileWriter::startTrack(void) {
+	if (m_out == NULL) {
+		writeError("Error: no output for MIDI file");
+		return false;
+	}
+	if (m_trackOpenQ && !endTrack()) {
+		return false;
+	}
+	if (!m_headerQ && !writeHeader()) {
+		return false;
+	}
+	if (m_seekableQ) {
+		// Write the chunk header with a size of 0 to be filled in later.
+		static const uchar chunk[8] = {'M', 'T', 'r', 'k', 0, 0, 0, 0};
+		m_trackPos = m_out->tellp();
+		m_out->write((const char*)chunk, 8);
+	}
+	m_trackOpenQ = true;
+	m_trackSize  = 0;
+	m_lastTick   = 0;
+	m_tracks++;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::endTrack -- Add an end-of-track message at the given
+//     absolute tick, and finish the track chunk.  If the tick is -1 (or
+//     before the last event), then the end-of-track message is placed
+//     at the time of the last event.
+//     Default value: tick = -1
+//
+
+bool MidiFileWriter::endTrack(int tick) {
+	if (!m_trackOpenQ) {
+		writeError("Error: no track to end");
+		return false;
+	}
+	static const uchar endoftrack[3] = {0xff, 0x2f, 0x00};
+	outputVLValue(tick > m_lastTick ? (ulong)(tick - m_lastTick) : 0);
+	output(endoftrack, 3);
+	m_trackOpenQ = false;
+
+	uchar size[4];
+	storeBigEndian(size, m_trackSize, 4);
+	if (m_seekableQ) {
+		std::streampos endpos = m_out->tellp();
+		m_out->seekp(m_trackPos + (std::streamoff)4);
+		m_out->write((const char*)size, 4);
+		m_out->seekp(endpos);
+	} else {
+		m_out->write("MTrk", 4);
+		m_out->write((const char*)size, 4);
+		m_out->write((const char*)m_buffer.data(), m_buffer.size());
+		m_buffer.clear();
+	}
+	if (m_out->fail()) {
+		writeError("Error: could not write MIDI track");
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::addEvent -- Write an event to the current track.  The
+//     tick is an absolute tick, and must not be earlier than the previous
+//     event in the track.  As in MidiFile::write(), the VLV length of
+//     0xf0 and 0xf7 messages is added automatically, and end-of-track
+//     messages are skipped (one is added by endTrack()).
+//
+
+bool MidiFileWriter::addEvent(int tick, const uchar* data, int size) {
+	if (!m_trackOpenQ) {
+		writeError("Error: startTrack() must be called before adding events");
+		return false;
+	}
+	if (tick < m_lastTick) {
+		writeError("Error: events must be added in tick order");
+		return false;
+	}
+	if (size <= 0) {
+		return true;
+	}
+	if ((size >= 2) && (data[0] == 0xff) && (data[1] == 0x2f)) {
+		return true;
+	}
+	outputVLValue(tick - m_lastTick);
+	m_lastTick = tick;
+	if ((data[0] == 0xf0) || (data[0] == 0xf7)) {
+		output(data, 1);
+		outputVLValue(size - 1);
+		output(data + 1, size - 1);
+	} else {
+		output(data, size);
+	}
+	return true;
+}
+
+
+bool MidiFileWriter::addEvent(int tick, const std::vector<uchar>& message) {
+	return addEvent(tick, message.data(), (int)message.size());
+}
+
+
+bool MidiFileWriter::addEvent(const MidiEvent& event) {
+	return addEvent(event.tick, event.data(), (int)event.size());
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::status -- Returns false if there was a problem writing.
+//
+
+bool MidiFileWriter::status(void) const {
+	return m_rwstatus;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::getErrorMessage -- Returns the description of the last
+//     problem writing, or an empty string if there was none.
+//
+
+const std::string& MidiFileWriter::getErrorMessage(void) const {
+	return m_errorMessage;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::setErrorPrinting -- Print error messages to std::cerr
+//     when there is a problem writing (off by default).  The message is
+//     always available from getErrorMessage().
+//
+
+void MidiFileWriter::setErrorPrinting(bool state) {
+	m_printErrorsQ = state;
+}
+
+
+void MidiFileWriter::setErrorPrintingOn(void) {
+	setErrorPrinting(true);
+}
+
+
+void MidiFileWriter::setErrorPrintingOff(void) {
+	setErrorPrinting(false);
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::getErrorPrinting -- Returns true if errors are printed.
+//
+
+bool MidiFileWriter::getErrorPrinting(void) const {
+	return m_printErrorsQ;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+//////////////////////////////
+//
+// MidiFileWriter::openStream -- Prepare to write to m_out.
+//
+
+bool MidiFileWriter::openStream(int tpq) {
+	m_rwstatus  = true;
+	m_errorMessage.clear();
+	m_seekableQ = m_out->tellp() != std::streampos(-1);
+	m_headerQ   = false;
+	m_trackOpenQ = false;
+	m_tracks    = 0;
+	m_ticksPerQuarterNote = tpq;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::writeHeader -- Write the header chunk.  For seekable
+//     output, the track count is written again by close().
+//
+
+bool MidiFileWriter::writeHeader(void) {
+	int count = m_declaredTracks;
+	if (count < 0) {
+		if (!m_seekableQ) {
+			writeError("Error: setTrackCount() is required for non-seekable output");
+			return false;
+		}
+		count = 0;
+	}
+	uchar header[14] = {'M', 'T', 'h', 'd'};
+	storeBigEndian(header + 4, 6, 4);
+	storeBigEndian(header + 8, count == 1 ? 0 : 1, 2);
+	storeBigEndian(header + 10, count, 2);
+	storeBigEndian(header + 12, m_ticksPerQuarterNote, 2);
+	if (m_seekableQ) {
+		m_headerPos = m_out->tellp();
+	}
+	m_out->write((const char*)header, 14);
+	m_headerQ = true;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::output -- Add bytes to the current track chunk data.
+//
+
+void MidiFileWriter::output(const uchar* data, ulong count) {
+	if (m_seekableQ) {
+		m_out->write((const char*)data, count);
+	} else {
+		m_buffer.insert(m_buffer.end(), data, data + count);
+	}
+	m_trackSize += count;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::outputVLValue -- Add a number to the current track
+//     data as a variable length value (see MidiFile::packVLValue()).
+//
+
+void MidiFileWriter::outputVLValue(ulong value) {
+	uchar bytes[4];
+	int count = MidiFile::packVLValue((long)value, bytes, m_printErrorsQ);
+	output(bytes, count);
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::writeError -- Store (and optionally print) an error
+//     message and mark the write status as failed.
+//
+
+void MidiFileWriter::writeError(const std::string& message) {
+	m_errorMessage = message;
+	if (m_printErrorsQ) {
+		std::cerr << message << std::endl;
+	}
+	m_rwstatus = false;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFileWriter::storeBigEndian -- Store a number in the given number of
+//     bytes, most significant byte first.
+//
+
+void MidiFileWriter::storeBigEndian(uchar* data, ulong value, int count) {
+	for (int i=count-1; i>=0; i--) {
+		data[i] = (uchar)(value & 0xff);
+		value >>= 8;
+	}
+}
+
+
+} // end of namespace smf
+
+
+
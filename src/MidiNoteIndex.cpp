@@ -0,0 +1,334 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 23:41:26 PDT 2026
+// Last Modified: Sat Oct 17 23:41:26 PDT 2026
+// Filename:      midifile/src/MidiNoteIndex.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   An interval index of the notes in a MidiNoteTable.
+//
+
+#include "MidiNoteIndex.h"
+
+#include <algorithm>
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// MidiNoteIndex::MidiNoteIndex -- Constructor.
+//
+
+MidiNoteIndex::MidiNoteIndex(void) {
+	// do nothing
+}
+
+
+MidiNoteIndex::MidiNoteIndex(const MidiNoteTable& notes) {
+	build(notes);
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteIndex::~MidiNoteIndex -- Deconstructor.
+//
+
+MidiNoteIndex::~MidiNoteIndex() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteIndex::build -- Index the notes in a MidiNoteTable.  The
+//    query results are indexes into the table, so the table should not
+//    be changed (or sorted) while the index is in use.  Times in seconds
+//    are only indexed if the MidiFile had a time analysis done before
+//    the table was built.
+//
+
+void MidiNoteIndex::build(const MidiNoteTable& notes) {
+	m_noteCount = notes.getNoteCount();
+	std::vector<double> starts(m_noteCount);
+	std::vector<double> ends(m_noteCount);
+
+	for (int i=0; i<m_noteCount; i++) {
+		starts[i] = notes[i].onTick;
+		ends[i] = notes[i].offTick;
+	}
+	m_ticks.build(starts, ends);
+
+	for (int i=0; i<m_noteCount; i++) {
+		starts[i] = notes[i].onSeconds;
+		ends[i] = notes[i].offSeconds;
+	}
+	m_seconds.build(starts, ends);
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteIndex::clear -- Remove all notes from the index.
+//
+
+void MidiNoteIndex::clear(void) {
+	m_ticks.clear();
+	m_seconds.clear();
+	m_noteCount = 0;
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteIndex::getNoteCount -- Return the number of notes in the
+//     indexed MidiNoteTable (including notes that are not indexed
+//     because they have no duration).
+//
+
+int MidiNoteIndex::getNoteCount(void) const {
+	return m_noteCount;
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteIndex::getNotesAtTick -- Store the indexes of the notes
+//     sounding at the given tick time.  Returns the number of notes.
+//
+
+int MidiNoteIndex::getNotesAtTick(std::vector<int>& indexes,
+		int tick) const {
+	indexes.clear();
+	m_ticks.findAt(indexes, tick);
+	return (int)indexes.size();
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteIndex::getNotesInTicks -- Store the indexes of the notes
+//     sounding at any time from starttick up to (but not including)
+//     endtick.  If endtick is not after starttick, then the notes
+//     sounding at starttick are returned.  Returns the number of notes.
+//
+
+int MidiNoteIndex::getNotesInTicks(std::vector<int>& indexes,
+		int starttick, int endtick) const {
+	indexes.clear();
+	m_ticks.findIn(indexes, starttick, endtick);
+	return (int)indexes.size();
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteIndex::getNotesAtSecond -- Store the indexes of the notes
+//     sounding at the given time in seconds.  Returns the number
+//     of notes.
+//
+
+int MidiNoteIndex::getNotesAtSecond(std::vector<int>& indexes,
+		double seconds) const {
+	indexes.clear();
+	m_seconds.findAt(indexes, seconds);
+	return (int)indexes.size();
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteIndex::getNotesInSeconds -- Store the indexes of the notes
+//     sounding at any time from startseconds up to (but not including)
+//     endseconds.  Returns the number of notes.
+//
+
+int MidiNoteIndex::getNotesInSeconds(std::vector<int>& indexes,
+		double startseconds, double endseconds) const {
+	indexes.clear();
+	m_seconds.findIn(indexes, startseconds, endseconds);
+	return (int)indexes.size();
+}
+
+
+
+//////////////////////////////
+//
+// _NoteIntervalTree::build -- Build a centered interval tree for the
+//     intervals [starts[i], ends[i]).  Each node stores the intervals
+//     which contain its center time (the median start time of the
+//     intervals given to the node), and the intervals before or after
+//     the center are passed on to the left or right child node.  Empty
+//     intervals are not stored.
+//
+
+void _NoteIntervalTree::build(const std::vector<double>& starts,
+		const std::vector<double>& ends) {
+	clear();
+	m_start = starts;
+	m_end = ends;
+
+	std::vector<int> intervals;
+	intervals.reserve(starts.size());
+	for (int i=0; i<(int)starts.size(); i++) {
+		if (ends[i] > starts[i]) {
+			intervals.push_back(i);
+		}
+	}
+	m_sorted = intervals;
+	std::sort(m_sorted.begin(), m_sorted.end(),
+		[this](int a, int b) {
+			if (m_start[a] != m_start[b]) {
+				return m_start[a] < m_start[b];
+			}
+			return a < b;
+		});
+
+	m_byStart.reserve(intervals.size());
+	m_byEnd.reserve(intervals.size());
+	buildNode(intervals, 0, (int)intervals.size());
+}
+
+
+
+//////////////////////////////
+//
+// _NoteIntervalTree::buildNode -- Add a node (and its children) for the
+//     intervals in the given range of the list.  The list range is
+//     reordered.  Returns the index of the node, or -1 if the range is
+//     empty.
+//
+
+int _NoteIntervalTree::buildNode(std::vector<int>& intervals, int first,
+		int last) {
+	if (first >= last) {
+		return -1;
+	}
+	auto begin = intervals.begin() + first;
+	auto end = intervals.begin() + last;
+	auto middle = begin + (last - first) / 2;
+	std::nth_element(begin, middle, end,
+		[this](int a, int b) { return m_start[a] < m_start[b]; });
+	double center = m_start[*middle];
+
+	auto overlap = std::partition(begin, end,
+		[this, center](int a) { return m_end[a] <= center; });
+	auto after = std::partition(overlap, end,
+		[this, center](int a) { return m_start[a] <= center; });
+
+	int node = (int)m_nodes.size();
+	m_nodes.emplace_back();
+	m_nodes[node].center = center;
+	m_nodes[node].first = (int)m_byStart.size();
+	m_nodes[node].count = (int)(after - overlap);
+
+	std::sort(overlap, after,
+		[this](int a, int b) { return m_start[a] < m_start[b]; });
+	m_byStart.insert(m_byStart.end(), overlap, after);
+	std::sort(overlap, after,
+		[this](int a, int b) { return m_end[a] > m_end[b]; });
+	m_byEnd.insert(m_byEnd.end(), overlap, after);
+
+	int overlapindex = (int)(overlap - intervals.begin());
+	int afterindex = (int)(after - intervals.begin());
+	int left = buildNode(intervals, first, overlapindex);
+	int right = buildNode(intervals, afterindex, last);
+	m_nodes[node].left = left;
+	m_nodes[node].right = right;
+	return node;
+}
+
+
+
+//////////////////////////////
+//
+// _NoteIntervalTree::clear -- Remove all intervals.
+//
+
+void _NoteIntervalTree::clear(void) {
+	m_start.clear();
+	m_end.clear();
+	m_nodes.clear();
+	m_byStart.clear();
+	m_byEnd.clear();
+	m_sorted.clear();
+}
+
+
+
+//////////////////////////////
+//
+// _NoteIntervalTree::findAt -- Append the intervals which contain the
+//     given time.  Only one node per tree level is visited, and the
+//     node lists are scanned only as far as the intervals that match.
+//
+
+void _NoteIntervalTree::findAt(std::vector<int>& indexes,
+		double time) const {
+	int node = m_nodes.empty() ? -1 : 0;
+	while (node >= 0) {
+		const _NoteIntervalNode& current = m_nodes[node];
+		int stop = current.first + current.count;
+		if (time < current.center) {
+			for (int i=current.first; i<stop; i++) {
+				if (m_start[m_byStart[i]] > time) {
+					break;
+				}
+				indexes.push_back(m_byStart[i]);
+			}
+			node = current.left;
+		} else if (time > current.center) {
+			for (int i=current.first; i<stop; i++) {
+				if (m_end[m_byEnd[i]] <= time) {
+					break;
+				}
+				indexes.push_back(m_byEnd[i]);
+			}
+			node = current.right;
+		} else {
+			indexes.insert(indexes.end(), m_byStart.begin() + current.first,
+					m_byStart.begin() + stop);
+			break;
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// _NoteIntervalTree::findIn -- Append the intervals which overlap the
+//     time range [starttime, endtime): the intervals which contain
+//     starttime, plus the intervals which start after starttime and
+//     before endtime.
+//
+
+void _NoteIntervalTree::findIn(std::vector<int>& indexes,
+		double starttime, double endtime) const {
+	findAt(indexes, starttime);
+	if (endtime <= starttime) {
+		return;
+	}
+	auto first = std::upper_bound(m_sorted.begin(), m_sorted.end(),
+		starttime, [this](double time, int a) { return time < m_start[a]; });
+	auto last = std::lower_bound(first, m_sorted.end(), endtime,
+		[this](int a, double time) { return m_start[a] < time; });
+	indexes.insert(indexes.end(), first, last);
+}
+
+
+} // end of namespace smf
+
+
+
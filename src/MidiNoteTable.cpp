@@ -0,0 +1,275 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sat Oct 17 23:14:08 PDT 2026
+// Last Modified: Sat Oct 17 23:14:08 PDT 2026
+// Filename:      midifile/src/MidiNoteTable.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   A table of the note-on/note-off pairs in a MidiFile.
+//
+
+#include "MidiNoteTable.h"
+
+#include <algorithm>
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// MidiNoteTable::MidiNoteTable -- Constructor.
+//
+
+MidiNoteTable::MidiNoteTable(void) {
+	// do nothing
+}
+
+
+MidiNoteTable::MidiNoteTable(const MidiFile& midifile) {
+	build(midifile);
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteTable::~MidiNoteTable -- Deconstructor.
+//
+
+MidiNoteTable::~MidiNoteTable() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteTable::build -- Fill the table with the notes of a MidiFile.
+//    Ticks are stored as absolute times even if the MidiFile is in
+//    delta tick mode.  Call MidiFile::doTimeAnalysis() before building
+//    the table to store times in seconds.  When given a single event
+//    list, the ticks in the list must be absolute, and the notes are
+//    stored with the given track number.
+//
+
+void MidiNoteTable::build(const MidiFile& midifile) {
+	clear();
+
+	int tracks = midifile.getTrackCount();
+	int count = 0;
+	for (int i=0; i<tracks; i++) {
+		const MidiEventList& eventlist = midifile[i];
+		for (int j=0; j<eventlist.size(); j++) {
+			if (eventlist[j].isNoteOn()) {
+				count++;
+			}
+		}
+	}
+	m_notes.reserve(count);
+
+	bool deltaQ = midifile.isDeltaTicks();
+	for (int i=0; i<tracks; i++) {
+		addTrack(midifile[i], i, deltaQ);
+	}
+}
+
+
+void MidiNoteTable::build(const MidiEventList& events, int track) {
+	clear();
+	addTrack(events, track, false);
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteTable::clear -- Remove all notes.
+//
+
+void MidiNoteTable::clear(void) {
+	m_notes.clear();
+	m_unterminated = 0;
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteTable::getNoteCount -- Return the number of notes in the table.
+//
+
+int MidiNoteTable::getNoteCount(void) const {
+	return (int)m_notes.size();
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteTable::getUnterminatedCount -- Return the number of notes
+//     which do not have a matching note-off.
+//
+
+int MidiNoteTable::getUnterminatedCount(void) const {
+	return m_unterminated;
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteTable::getNote -- Return a note in the table.
+//
+
+const MidiNote& MidiNoteTable::getNote(int index) const {
+	return m_notes[index];
+}
+
+
+const MidiNote& MidiNoteTable::operator[](int index) const {
+	return m_notes[index];
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteTable::sortByOnset -- Sort the notes by note-on time.  Notes
+//     which start at the same tick are ordered by track, and then by
+//     position in the track.
+//
+
+void MidiNoteTable::sortByOnset(void) {
+	std::sort(m_notes.begin(), m_notes.end(),
+		[](const MidiNote& a, const MidiNote& b) {
+			if (a.onTick != b.onTick) {
+				return a.onTick < b.onTick;
+			}
+			if (a.track != b.track) {
+				return a.track < b.track;
+			}
+			return a.onIndex < b.onIndex;
+		});
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteTable::linkEvents -- Link the note-on and note-off events of
+//     each note in the MidiFile the table was built from.  Note events
+//     which are not part of a complete note are unlinked, and other
+//     events are not changed.  The MidiFile must not have been edited
+//     since the table was built.  Returns the number of linked notes.
+//
+
+int MidiNoteTable::linkEvents(MidiFile& midifile) const {
+	int tracks = midifile.getTrackCount();
+	for (int i=0; i<tracks; i++) {
+		MidiEventList& eventlist = midifile[i];
+		for (int j=0; j<eventlist.size(); j++) {
+			if (eventlist[j].isNote()) {
+				eventlist[j].unlinkEvent();
+			}
+		}
+	}
+
+	int counter = 0;
+	for (const MidiNote& note : m_notes) {
+		if ((note.offIndex < 0) || (note.track >= tracks)) {
+			continue;
+		}
+		MidiEventList& eventlist = midifile[note.track];
+		eventlist[note.onIndex].linkEvent(eventlist[note.offIndex]);
+		counter++;
+	}
+	return counter;
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteTable::addTrack -- Pair the note-ons and note-offs of a track
+//     and append the notes to the table.  Waiting notes are queued on
+//     their channel/key in FIFO order: a new note-on is appended to the
+//     end of the queue, and a note-off ends the note at the front.
+//
+
+void MidiNoteTable::addTrack(const MidiEventList& events, int track,
+		bool deltaQ) {
+	// First and last entry in m_notes for the notes waiting for a
+	// note-off on each channel/key (channel * 128 + key), or -1 if none.
+	// The queues are linked through the offIndex of the waiting notes.
+	int queuehead[16 * 128];
+	int queuetail[16 * 128];
+	std::fill(queuehead, queuehead + 16 * 128, -1);
+	std::fill(queuetail, queuetail + 16 * 128, -1);
+
+	int tick = 0;
+	for (int i=0; i<events.size(); i++) {
+		const MidiEvent& event = events[i];
+		if (deltaQ) {
+			tick += event.tick;
+		} else {
+			tick = event.tick;
+		}
+		if (event.isNoteOn()) {
+			int slot = event.getChannel() * 128 + event.getKeyNumber();
+			MidiNote note;
+			note.onTick      = tick;
+			note.offTick     = tick;
+			note.onSeconds   = event.seconds;
+			note.offSeconds  = event.seconds;
+			note.onIndex     = i;
+			note.offIndex    = -1;
+			note.track       = (short)track;
+			note.key         = (uchar)event.getKeyNumber();
+			note.channel     = (uchar)event.getChannel();
+			note.onVelocity  = (uchar)event.getVelocity();
+			note.offVelocity = 0;
+			int index = (int)m_notes.size();
+			m_notes.push_back(note);
+			if (queuetail[slot] < 0) {
+				queuehead[slot] = index;
+			} else {
+				m_notes[queuetail[slot]].offIndex = index;
+			}
+			queuetail[slot] = index;
+		} else if (event.isNoteOff()) {
+			int slot = event.getChannel() * 128 + event.getKeyNumber();
+			int index = queuehead[slot];
+			if (index < 0) {
+				continue;
+			}
+			MidiNote& note = m_notes[index];
+			queuehead[slot] = note.offIndex;
+			if (note.offIndex < 0) {
+				queuetail[slot] = -1;
+			}
+			note.offTick     = tick;
+			note.offSeconds  = event.seconds;
+			note.offIndex    = i;
+			note.offVelocity = (uchar)event.getVelocity();
+		}
+	}
+
+	// Notes still waiting at the end of the track have no note-off:
+	for (int slot=0; slot<16 * 128; slot++) {
+		int index = queuehead[slot];
+		while (index >= 0) {
+			int next = m_notes[index].offIndex;
+			m_notes[index].offIndex = -1;
+			m_unterminated++;
+			index = next;
+		}
+	}
+}
+
+
+} // end of namespace smf
+
+
+
@@ -0,0 +1,227 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 00:07:53 PDT 2026
+// Last Modified: Sun Oct 18 00:07:53 PDT 2026
+// Filename:      midifile/src/MidiSonorityIterator.cpp
+// Website:       http://midifile.sapp.org
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Iterate through the vertical slices (sonorities) of the
+//                notes in a MidiNoteTable.
+//
+
+#include "MidiSonorityIterator.h"
+
+#include <algorithm>
+
+
+namespace smf {
+
+//////////////////////////////
+//
+// MidiSonorityIterator::MidiSonorityIterator -- Constructor.
+//
+
+MidiSonorityIterator::MidiSonorityIterator(void) {
+	// do nothing
+}
+
+
+MidiSonorityIterator::MidiSonorityIterator(const MidiNoteTable& notes) {
+	start(notes);
+}
+
+
+
+//////////////////////////////
+//
+// MidiSonorityIterator::~MidiSonorityIterator -- Deconstructor.
+//
+
+MidiSonorityIterator::~MidiSonorityIterator() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// MidiSonorityIterator::setDrums -- Include notes on the General MIDI
+//     percussion channel (channel 10, 0x09) in the slices (the default),
+//     or ignore them.  Must be set before start().
+//
+
+void MidiSonorityIterator::setDrums(bool state) {
+	m_drumsQ = state;
+}
+
+
+void MidiSonorityIterator::setDrumsOn(void) {
+	setDrums(true);
+}
+
+
+void MidiSonorityIterator::setDrumsOff(void) {
+	setDrums(false);
+}
+
+
+
+//////////////////////////////
+//
+// MidiSonorityIterator::getDrums -- Returns true if percussion notes are
+//     included in the slices.
+//
+
+bool MidiSonorityIterator::getDrums(void) const {
+	return m_drumsQ;
+}
+
+
+
+//////////////////////////////
+//
+// MidiSonorityIterator::start -- Prepare to iterate through the slices
+//     of a MidiNoteTable.  The table must not be changed or deleted
+//     while iterating.  Notes with no duration (such as notes without
+//     note-offs) do not sound and are ignored.
+//
+
+void MidiSonorityIterator::start(const MidiNoteTable& notes) {
+	m_table = &notes;
+	m_onsets.clear();
+	m_onsets.reserve(notes.getNoteCount());
+	for (int i=0; i<notes.getNoteCount(); i++) {
+		const MidiNote& note = notes[i];
+		if (note.offTick <= note.onTick) {
+			continue;
+		}
+		if (!m_drumsQ && (note.channel == 0x09)) {
+			continue;
+		}
+		m_onsets.push_back(i);
+	}
+	m_offsets = m_onsets;
+
+	const std::vector<MidiNote>& list = notes.getNotes();
+	std::sort(m_onsets.begin(), m_onsets.end(),
+		[&list](int a, int b) {
+			if (list[a].onTick != list[b].onTick) {
+				return list[a].onTick < list[b].onTick;
+			}
+			return a < b;
+		});
+	std::sort(m_offsets.begin(), m_offsets.end(),
+		[&list](int a, int b) {
+			if (list[a].offTick != list[b].offTick) {
+				return list[a].offTick < list[b].offTick;
+			}
+			return a < b;
+		});
+
+	rewind();
+}
+
+
+
+//////////////////////////////
+//
+// MidiSonorityIterator::rewind -- Go back to the first slice.
+//
+
+void MidiSonorityIterator::rewind(void) {
+	m_nextOnset = 0;
+	m_nextOffset = 0;
+	m_active.clear();
+}
+
+
+
+//////////////////////////////
+//
+// MidiSonorityIterator::next -- Store the next slice in the given
+//     sonority.  The slices cover the time from the first note-on to
+//     the last note-off, and slices with no sounding notes are rests.
+//     Returns false when there are no more slices.
+//
+
+bool MidiSonorityIterator::next(MidiSonority& sonority) {
+	if (m_table == nullptr) {
+		return false;
+	}
+	double seconds;
+	int tick = getNextTick(seconds);
+	if (tick < 0) {
+		return false;
+	}
+
+	const std::vector<MidiNote>& list = m_table->getNotes();
+	while ((m_nextOffset < (int)m_offsets.size()) &&
+			(list[m_offsets[m_nextOffset]].offTick == tick)) {
+		int index = m_offsets[m_nextOffset++];
+		auto it = std::find(m_active.begin(), m_active.end(), index);
+		if (it != m_active.end()) {
+			m_active.erase(it);
+		}
+	}
+	sonority.attacks.reset();
+	while ((m_nextOnset < (int)m_onsets.size()) &&
+			(list[m_onsets[m_nextOnset]].onTick == tick)) {
+		int index = m_onsets[m_nextOnset++];
+		m_active.push_back(index);
+		sonority.attacks.set(list[index].key);
+	}
+
+	double endseconds;
+	int endtick = getNextTick(endseconds);
+	if (endtick < 0) {
+		// Past the last note-off, so there is nothing sounding.
+		return false;
+	}
+
+	sonority.startTick = tick;
+	sonority.endTick = endtick;
+	sonority.startSeconds = seconds;
+	sonority.endSeconds = endseconds;
+	sonority.keys.reset();
+	for (int index : m_active) {
+		sonority.keys.set(list[index].key);
+	}
+	sonority.notes = m_active;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiSonorityIterator::getNextTick -- Return the tick of the next
+//     note-on or note-off, and store its time in seconds.  Returns -1
+//     if there are no more note-ons or note-offs.
+//
+
+int MidiSonorityIterator::getNextTick(double& seconds) const {
+	const std::vector<MidiNote>& list = m_table->getNotes();
+	int tick = -1;
+	seconds = 0.0;
+	if (m_nextOffset < (int)m_offsets.size()) {
+		const MidiNote& note = list[m_offsets[m_nextOffset]];
+		tick = note.offTick;
+		seconds = note.offSeconds;
+	}
+	if (m_nextOnset < (int)m_onsets.size()) {
+		const MidiNote& note = list[m_onsets[m_nextOnset]];
+		if ((tick < 0) || (note.onTick < tick)) {
+			tick = note.onTick;
+			seconds = note.onSeconds;
+		}
+	}
+	return tick;
+}
+
+
+} // end of namespace smf
+
+
+
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Thu Feb 19 20:43:49 PST 2015
-// Last Modified: Thu Feb 19 20:43:52 PST 2015
+// Last Modified: Sat Oct 17 23:14:08 PDT 2026 Use MidiNoteTable.
 // Filename:      tools/durations.cpp
 // URL:           https://github.com/craigsapp/midifile/blob/master/tools/durations.cpp
 // Syntax:        C++11
@@ -14,6 +14,7 @@
 
 #include "Options.h"
 #include "MidiFile.h"
+#include "MidiNoteTable.h"
 
 #include <iostream>
 
@@ -52,16 +53,14 @@ int main(int argc, char** argv) {
 	}
 
 	int tpq = midifile.getTicksPerQuarterNote();
-	midifile.linkNotePairs();
-	if (joinQ) {
-		midifile.joinTracks();
-	}
-	MidiEvent* mev;
-	double duration;
-
 	if (secondsQ) {
 		midifile.doTimeAnalysis();
 	}
+	MidiNoteTable notes(midifile);
+	if (joinQ) {
+		notes.sortByOnset();
+	}
+	double duration;
 
 	if (secondsQ) {
 		cout << "SEC\tDUR\tTRACK\tNOTE\n";
@@ -72,33 +71,35 @@ int main(int argc, char** argv) {
 	}
 	cout << "============================\n";
 
-	for (int track=0; track < midifile.getTrackCount(); track++) {
-		for (int i=0; i<midifile[track].size(); i++) {
-			mev = &midifile[track][i];
-			if (!mev->isNoteOn()) {
-				continue;
+	int groups = joinQ ? 1 : midifile.getTrackCount();
+	int index = 0;
+	for (int group=0; group<groups; group++) {
+		for ( ; index<notes.size(); index++) {
+			const MidiNote& note = notes[index];
+			if (!joinQ && (note.track != group)) {
+				break;
 			}
 			if (secondsQ) {
-				duration = mev->getDurationInSeconds();
+				duration = note.getDuration();
 			} else {
-				duration = mev->getTickDuration();
+				duration = note.getTickDuration();
 			}
 
 			if (secondsQ) {
-				cout << mev->seconds << '\t';
+				cout << note.onSeconds << '\t';
 				cout << duration << '\t';
 			} else if (quarterQ) {
-				cout << mev->tick/tpq << '\t';
+				cout << note.onTick/tpq << '\t';
 				cout << duration/tpq << '\t';
 			} else {
-				cout << mev->tick << '\t';
+				cout << note.onTick << '\t';
 				cout << duration << '\t';
 			}
-			cout << mev->track << '\t';
-			cout << mev->getKeyNumber();
+			cout << note.track << '\t';
+			cout << (int)note.key;
 			cout << endl;
 		}
-		if (midifile.getTrackCount() > 1) {
+		if (groups > 1) {
 			cout << endl;
 		}
 	}
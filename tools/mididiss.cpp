@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Jul  3 11:58:38 PDT 2023
-// Last Modified: Mon Jul 10 22:02:03 PDT 2023
+// Last Modified: Sun Oct 18 00:07:53 PDT 2026 Use MidiSonorityIterator.
 // Filename:      tools/mididiss.cpp
 // URL:           https://github.com/craigsapp/midifile/blob/master/tools/mididiss.cpp
 // Syntax:        C++11
@@ -24,6 +24,7 @@
 //
 
 #include "MidiFile.h"
+#include "MidiSonorityIterator.h"
 #include "Options.h"
 
 #include <iostream>
@@ -32,8 +33,6 @@ using namespace std;
 using namespace smf;
 
 
-vector<int> Errors(128, 0);
-
 bool dataQ = false;
 bool dataNoRestQ = false;
 bool intervalQ = false;
@@ -51,7 +50,7 @@ class Sonority {
 };
 
 
-void     addSonority(int tick, vector<Sonority>& sonorities, vector<int>& activeNotes);
+void     addSonority(int tick, vector<Sonority>& sonorities, const bitset<128>& keys);
 int      calculateSonorityScore(Sonority& sonority);
 double   calculateFinalScore(vector<Sonority>& sonorities);
 void     calculateSonorityDurations(vector<Sonority>& sonorities, MidiFile& midifile);
@@ -60,7 +59,6 @@ void     doSonorityAnalysis(vector<Sonority>& sonorities, MidiFile& midifile);
 int      getIntervalScore(int a, int b);
 void     printSonorityInfo(vector<Sonority>& sonorities, bool restQ = true);
 void     processFile(MidiFile& midifile, Options& options);
-int      updateActiveNotes(MidiEventList& events, int start, vector<int>& activeNotes);
 double   weightedAverage(vector<double>& values, vector<double>& weights);
 
 ostream& operator<<(ostream& output, Sonority& sonority);
@@ -180,26 +178,23 @@ ostream& operator<<(ostream& out, Sonority& sonority) {
 //
 
 void processFile(MidiFile& midifile, Options& options) {
-	midifile.linkNotePairs();
-	midifile.joinTracks();
+	MidiNoteTable notes(midifile);
+	MidiSonorityIterator iterator;
+	iterator.setDrumsOff();
+	iterator.start(notes);
 
 	vector<Sonority> sonorities;
 	sonorities.reserve(10000);
 
-	vector<int> activeNotes(128, 0);
-	for (int i=0; i<midifile[0].getEventCount(); i++) {
-		MidiEvent* event = &midifile[0][i];
-		if (!(event->isNoteOn() ||event->isNoteOff())) {
-			continue;
-		}
-		int channel = event->getChannel();
-		if (channel == 0x09) {
-			// ignore drum track
-			continue;
-		}
-		int tick = event->tick;
-		i = updateActiveNotes(midifile[0], i, activeNotes);
-		addSonority(tick, sonorities, activeNotes);
+	MidiSonority slice;
+	bool found = false;
+	while (iterator.next(slice)) {
+		addSonority(slice.startTick, sonorities, slice.keys);
+		found = true;
+	}
+	if (found) {
+		// rest after the last note-off:
+		addSonority(slice.endTick, sonorities, bitset<128>());
 	}
 	doSonorityAnalysis(sonorities, midifile);
 	if (dataQ || dataNoRestQ) {
@@ -359,57 +354,19 @@ void calculateSonorityDurations(vector<Sonority>& sonorities, MidiFile& midifile
 
 
 
-///////////////////////////////
-//
-// updateActiveNotes --
-//
-
-int updateActiveNotes(MidiEventList& events, int start, vector<int>& activeNotes) {
-	MidiEvent* event = &events[start];
-	int startTick = event->tick;
-	int i = start;
-	for (i=start; i<events.getEventCount(); i++) {
-		event = &events[i];
-		int tick = event->tick;
-		if (tick != startTick) {
-			i--;
-			break;
-		}
-		if (!(event->isNoteOn() || event->isNoteOff())) {
-			continue;
-		}
-		int key = event->getKeyNumber();
-		if (event->isNoteOn()) {
-			activeNotes[key]++;
-		} else if (event->isNoteOff()) {
-			activeNotes[key]--;
-		}
-	}
-	return i;
-}
-
-
-
 //////////////////////////////
 //
 // addSonority -- Add a sonority to the list of sonorities.
 //
 
-void addSonority(int tick, vector<Sonority>& sonorities, vector<int>& activeNotes) {
+void addSonority(int tick, vector<Sonority>& sonorities, const bitset<128>& keys) {
 	sonorities.emplace_back();
 	sonorities.back().startTick = tick;
 
 	Sonority& curr = sonorities.back();
 	for (int i=0; i<128; i++) {
-		if (activeNotes[i] > 0) {
+		if (keys[i]) {
 			curr.pitches.push_back(i);
-		} else if (activeNotes[i] < 0) {
-			if (Errors[i] == 0) {
-				if (i > 0) {
-					cerr << "Error excessive note-offs for pitch " << i << " starting at tick " << tick << endl;
-				}
-			}
-			Errors[i]++;
 		}
 	}
 }
@@ -0,0 +1,194 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 00:31:17 PDT 2026
+// Last Modified: Sun Oct 18 00:31:17 PDT 2026
+// Filename:      tools/mididups.cpp
+// URL:           https://github.com/craigsapp/midifile/blob/master/tools/mididups.cpp
+// Syntax:        C++11
+// vim:           ts=3
+//
+// Description:   Find MIDI files which contain the same music, even if
+//                the files are not byte-for-byte identical (such as
+//                files with different track orders, running status or
+//                note-off styles).  Files are compared with
+//                MidiFile::getFingerprint().  Each group of duplicate
+//                files is printed with one filename per line, and the
+//                groups are separated by blank lines.  If no filenames
+//                are given on the command line, the list of files is
+//                read from standard input (one filename per line).
+//
+// Options:       -a   :: print the fingerprint of every file instead of
+//                        the duplicate groups
+//                -f   :: print the fingerprint before each group
+//                -t # :: number of reading threads (0 = one per core)
+//
+
+#include "MidiFile.h"
+#include "MidiFileBatch.h"
+#include "Options.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace smf;
+
+
+void   getFilenames        (vector<string>& filenames, Options& options);
+void   printFingerprint    (uint64_t fingerprint);
+void   printDuplicates     (vector<uint64_t>& fingerprints,
+                            vector<char>& status, vector<string>& filenames,
+                            bool fingerprintQ);
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.define("a|all=b",         "Print the fingerprint of every file.");
+	options.define("f|fingerprint=b", "Print the fingerprint of each group.");
+	options.define("t|threads=i:0",   "Number of reading threads (0 = one per core).");
+	options.process(argc, argv);
+
+	vector<string> filenames;
+	getFilenames(filenames, options);
+
+	vector<uint64_t> fingerprints(filenames.size(), 0);
+	vector<char> status(filenames.size(), 0);
+
+	MidiFileBatch batch;
+	batch.setThreadCount(options.getInteger("threads"));
+	batch.setKeepFilesOff();
+	batch.setCallback([&](int index, MidiFile& midifile, bool readQ) {
+		if (readQ) {
+			fingerprints[index] = midifile.getFingerprint();
+			status[index] = 1;
+		}
+	});
+	batch.read(filenames);
+
+	for (int i=0; i<batch.getFileCount(); i++) {
+		if (!status[i]) {
+			cerr << filenames[i] << ": " << batch.getErrorMessage(i) << endl;
+		}
+	}
+
+	if (options.getBoolean("all")) {
+		for (int i=0; i<(int)filenames.size(); i++) {
+			if (!status[i]) {
+				continue;
+			}
+			printFingerprint(fingerprints[i]);
+			cout << '\t' << filenames[i] << endl;
+		}
+	} else {
+		printDuplicates(fingerprints, status, filenames,
+				options.getBoolean("fingerprint"));
+	}
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////
+//
+// getFilenames -- Get the list of files from the command line, or from
+//     standard input if there are no command-line arguments.
+//
+
+void getFilenames(vector<string>& filenames, Options& options) {
+	filenames.clear();
+	if (options.getArgCount() > 0) {
+		for (int i=1; i<=options.getArgCount(); i++) {
+			filenames.push_back(options.getArg(i));
+		}
+		return;
+	}
+	string line;
+	while (getline(cin, line)) {
+		if (!line.empty() && (line.back() == '\r')) {
+			line.pop_back();
+		}
+		if (!line.empty()) {
+			filenames.push_back(line);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// printDuplicates -- Print each group of files which have the same
+//     fingerprint.  Groups are printed in the order of their first file
+//     in the input list.
+//
+
+void printDuplicates(vector<uint64_t>& fingerprints, vector<char>& status,
+		vector<string>& filenames, bool fingerprintQ) {
+	vector<int> order;
+	order.reserve(filenames.size());
+	for (int i=0; i<(int)filenames.size(); i++) {
+		if (status[i]) {
+			order.push_back(i);
+		}
+	}
+	sort(order.begin(), order.end(), [&](int a, int b) {
+		if (fingerprints[a] != fingerprints[b]) {
+			return fingerprints[a] < fingerprints[b];
+		}
+		return a < b;
+	});
+
+	// groups of duplicates, stored as [start, end) ranges in order:
+	vector<pair<int, int>> groups;
+	int start = 0;
+	for (int i=1; i<=(int)order.size(); i++) {
+		if ((i < (int)order.size()) &&
+				(fingerprints[order[i]] == fingerprints[order[start]])) {
+			continue;
+		}
+		if (i - start > 1) {
+			groups.emplace_back(start, i);
+		}
+		start = i;
+	}
+	sort(groups.begin(), groups.end(),
+		[&](const pair<int, int>& a, const pair<int, int>& b) {
+			return order[a.first] < order[b.first];
+		});
+
+	for (int i=0; i<(int)groups.size(); i++) {
+		if (i > 0) {
+			cout << endl;
+		}
+		if (fingerprintQ) {
+			printFingerprint(fingerprints[order[groups[i].first]]);
+			cout << endl;
+		}
+		for (int j=groups[i].first; j<groups[i].second; j++) {
+			cout << filenames[order[j]] << endl;
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// printFingerprint -- Print a fingerprint as 16 hex digits.
+//
+
+void printFingerprint(uint64_t fingerprint) {
+	cout << hex << setw(16) << setfill('0') << fingerprint
+	     << dec << setfill(' ');
+}
+
+
+
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Jul  3 07:24:54 PDT 2023
-// Last Modified: Mon Jul  3 07:24:58 PDT 2023
+// Last Modified: Sat Oct 17 13:14:52 PDT 2026
 // Filename:      tools/midireg.cpp
 // URL:           https://github.com/craigsapp/midifile/blob/master/tools/midireg.cpp
 // Syntax:        C++11
@@ -15,6 +15,7 @@
 //                
 //
 
+#include "MidiColumns.h"
 #include "MidiFile.h"
 #include "Options.h"
 
@@ -63,8 +64,10 @@ int main(int argc, char** argv) {
 //
 
 void processFile(MidiFile& midifile, Options& options) {
-	midifile.linkNotePairs();
-	midifile.joinTracks();
+	MidiColumns columns(midifile);
+	const vector<uchar>& status = columns.getStatus();
+	const vector<uchar>& data1  = columns.getData1();
+	const vector<uchar>& data2  = columns.getData2();
 
 	int lowCut = options.getInteger("lower-boundary");
 	int hiCut  = options.getInteger("upper-boundary");
@@ -78,16 +81,16 @@ void processFile(MidiFile& midifile, Options& options) {
 
 	bool fractionQ = options.getBoolean("fraction");
 
-	for (int e=0; e<midifile[0].getEventCount(); e++) {
-		MidiEvent *note = &midifile[0][e];
-		if (!note->isNoteOn()) {
+	for (int e=0; e<columns.getEventCount(); e++) {
+		if (((status[e] & 0xf0) != 0x90) || (data2[e] == 0)) {
+			// not a note-on
 			continue;
 		}
-		int channel  = note->getChannel();
+		int channel = status[e] & 0x0f;
 		if (channel == 0x09) {
 			continue;
 		}
-		int key = note->getKeyNumber();
+		int key = data1[e];
 		if (splitQ) {
 			if (key < splitCut) {
 				lowCount++;